@@ -53,16 +53,13 @@ bool SocketIOclient::send(socketIOmessageType_t type, uint8_t * payload, size_t
     }
     if(clientIsConnected(&_client)) {
         if(!headerToPayload) {
-            // webSocket Header
-            ret = WebSocketsClient::sendFrameHeader(&_client, WSop_text, length + 2, true);
-            // Engine.IO / Socket.IO Header
-            if(ret) {
-                uint8_t buf[3] = { eIOtype_MESSAGE, type, 0x00 };
-                ret            = WebSocketsClient::write(&_client, buf, 2);
-            }
-            if(ret && payload && length > 0) {
-                ret = WebSocketsClient::write(&_client, payload, length);
-            }
+            // webSocket Header, Engine.IO / Socket.IO Header and payload in one write
+            uint8_t buf[3]      = { eIOtype_MESSAGE, type, 0x00 };
+            WSslice_t slices[2] = {
+                { buf, 2 },
+                { payload, (payload ? length : 0) }
+            };
+            ret = WebSocketsClient::sendFrameSlices(&_client, WSop_text, slices, 2, true);
             return ret;
         } else {
             // TODO implement
@@ -55,6 +55,8 @@ extern "C" {
 
 #endif
 
+#include "libwsdeflate/wsdeflate.h"
+
 /**
  *
  * @param client WSclient_t *  ptr to the client struct
@@ -85,8 +87,9 @@ void WebSockets::clientDisconnect(WSclient_t * client, uint16_t code, char * rea
  * @param mask bool             add dummy mask to the frame (needed for web browser)
  * @param maskkey uint8_t[4]    key used for payload
  * @param fin bool              can be used to send data in more then one frame (set fin on the last frame)
+ * @param rsv1 bool             set for a message compressed with permessage-deflate
  */
-uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin) {
+uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin, bool rsv1) {
     uint8_t headerSize;
     // calculate header Size
     if(length < 126) {
@@ -108,6 +111,9 @@ uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t
     if(fin) {
         *headerPtr |= bit(7);    ///< set Fin
     }
+    if(rsv1) {
+        *headerPtr |= bit(6);    ///< set RSV1, compressed message
+    }
     *headerPtr |= opcode;    ///< set opcode
     headerPtr++;
 
@@ -162,6 +168,58 @@ uint8_t WebSockets::createHeader(uint8_t * headerPtr, WSopcode_t opcode, size_t
     return headerSize;
 }
 
+/**
+ * XOR (un)masks a payload in place with the 4 byte mask key
+ * the unaligned head and tail are done byte wise, the body one word at a time
+ * @param data uint8_t *         ptr to the payload
+ * @param length size_t          length of the payload
+ * @param maskKey uint8_t[4]     key used for the payload
+ * @param offset size_t          position of data in the frame payload, selects the key byte to start with
+ */
+void WebSockets::maskPayload(uint8_t * data, size_t length, const uint8_t maskKey[4], size_t offset) {
+    typedef uint32_t __attribute__((__may_alias__)) maskWord_t;
+
+    size_t i = 0;
+
+    // head until data is word aligned
+    while(i < length && ((uintptr_t)(data + i) & (sizeof(maskWord_t) - 1))) {
+        data[i] ^= maskKey[(offset + i) & 3];
+        i++;
+    }
+
+    if(length - i >= sizeof(maskWord_t)) {
+        // rotate the key so it lines up with the aligned body
+        uint8_t rotatedKey[4];
+        for(uint8_t k = 0; k < 4; k++) {
+            rotatedKey[k] = maskKey[(offset + i + k) & 3];
+        }
+
+        maskWord_t key;
+        memcpy(&key, rotatedKey, sizeof(key));
+
+#if defined(__x86_64__) || defined(__aarch64__)
+        // 64 bit hosts, the compiler vectorizes this loop further
+        typedef uint64_t __attribute__((__may_alias__)) maskLongWord_t;
+        maskLongWord_t longKey = ((maskLongWord_t)key << 32) | key;
+        for(; length - i >= sizeof(maskLongWord_t); i += sizeof(maskLongWord_t)) {
+            maskLongWord_t longWord;
+            memcpy(&longWord, data + i, sizeof(longWord));
+            longWord ^= longKey;
+            memcpy(data + i, &longWord, sizeof(longWord));
+        }
+#endif
+
+        for(; length - i >= sizeof(maskWord_t); i += sizeof(maskWord_t)) {
+            *(maskWord_t *)(data + i) ^= key;
+        }
+    }
+
+    // tail
+    for(; i < length; i++) {
+        data[i] ^= maskKey[(offset + i) & 3];
+    }
+}
+
 /**
  *
  * @param client WSclient_t *   ptr to the client struct
@@ -218,8 +276,33 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
     uint8_t * headerPtr;
     uint8_t * payloadPtr = payload;
     bool useInternBuffer = false;
+    bool compressed      = false;
     bool ret             = true;
 
+    if(client->cDeflate && fin && (opcode == WSop_text || opcode == WSop_binary) && length >= WEBSOCKETS_DEFLATE_MIN_SIZE && payload) {
+        // compress to the transmit buffer, a payload that is already in there is send as is
+        uint8_t * source    = headerToPayload ? (payload + WEBSOCKETS_MAX_HEADER_SIZE) : payload;
+        uint8_t * txPayload = reserveTxBuffer(client, 0);
+        if(txPayload && payload != client->cTxBuffer) {
+            int32_t result = wsdeflate_compress(source, length, txPayload, WEBSOCKETS_TX_BUFFER_SIZE, client->cDeflateWindowBits, client->cDeflateWindow, client->cDeflateWindowFill);
+            // uncompressed messages are not part of the history of the receiver
+            if(result >= 0 && (size_t)result < length) {
+                DEBUG_WEBSOCKETS("[WS][%d][sendFrame] deflate %u -> %d\n", client->num, length, result);
+                if(client->cDeflateWindow) {
+                    updateDeflateWindow(client->cDeflateWindow, &client->cDeflateWindowFill, client->cDeflateWindowBits, source, length);
+                }
+                payloadPtr      = client->cTxBuffer;
+                length          = result;
+                headerToPayload = true;
+                compressed      = true;
+            }
+        }
+    }
+
+    if(_fragmentSize && fin && !compressed && (opcode == WSop_text || opcode == WSop_binary) && length > _fragmentSize && payload != client->cTxBuffer) {
+        return sendFragments(client, opcode, (headerToPayload ? (payload + WEBSOCKETS_MAX_HEADER_SIZE) : payload), length);
+    }
+
     // calculate header Size
     if(length < 126) {
         headerSize = 2;
@@ -233,20 +316,23 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         headerSize += 4;
     }
 
-#ifdef WEBSOCKETS_USE_BIG_MEM
-    // only for ESP since AVR has less HEAP
-    // try to send data in one TCP package (only if some free Heap is there)
-    if(!headerToPayload && ((length > 0) && (length < 1400)) && (GET_FREE_HEAP > 6000)) {
-        DEBUG_WEBSOCKETS("[WS][%d][sendFrame] pack to one TCP package...\n", client->num);
-        uint8_t * dataPtr = (uint8_t *)malloc(length + WEBSOCKETS_MAX_HEADER_SIZE);
-        if(dataPtr) {
-            memcpy((dataPtr + WEBSOCKETS_MAX_HEADER_SIZE), payload, length);
+    if(!headerToPayload && payload && length > 0) {
+        // copy to the transmit buffer to send header and payload in one TCP package
+        uint8_t * txPayload = reserveTxBuffer(client, length);
+        if(txPayload) {
+            DEBUG_WEBSOCKETS("[WS][%d][sendFrame] pack to one TCP package...\n", client->num);
+            if(txPayload != payload) {
+                memcpy(txPayload, payload, length);
+            }
             headerToPayload = true;
-            useInternBuffer = true;
-            payloadPtr      = dataPtr;
+            payloadPtr      = client->cTxBuffer;
+        } else {
+            DEBUG_WEBSOCKETS("[WS][%d][sendFrame] payload does not fit the tx buffer, header and payload are send separately\n", client->num);
         }
     }
-#endif
+
+    // the transmit buffer is ours, so it may be masked in place
+    useInternBuffer = (payloadPtr && payloadPtr == client->cTxBuffer);
 
     // set Header Pointer
     if(headerToPayload) {
@@ -264,7 +350,7 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
         }
     }
 
-    createHeader(headerPtr, opcode, length, client->cIsClient, maskKey, fin);
+    createHeader(headerPtr, opcode, length, client->cIsClient, maskKey, fin, compressed);
 
     if(client->cIsClient && useInternBuffer) {
         uint8_t * dataMaskPtr;
@@ -275,9 +361,7 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
             dataMaskPtr = payloadPtr;
         }
 
-        for(size_t x = 0; x < length; x++) {
-            dataMaskPtr[x] = (dataMaskPtr[x] ^ maskKey[x % 4]);
-        }
+        maskPayload(dataMaskPtr, length, maskKey);
     }
 
 #ifndef NODEBUG_WEBSOCKETS
@@ -292,28 +376,68 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
             ret = false;
         }
     } else {
-        // send header
-        if(write(client, &buffer[0], headerSize) != headerSize) {
+        // send header and payload gathered in as few TCP packages as possible
+        WSslice_t slices[2] = {
+            { &buffer[0], headerSize },
+            { payloadPtr, (payloadPtr ? length : 0) }
+        };
+
+        if(writeSlices(client, slices, 2) != (headerSize + slices[1].length)) {
             ret = false;
         }
+    }
 
-        if(payloadPtr && length > 0) {
-            // send payload
-            if(write(client, &payloadPtr[0], length) != length) {
-                ret = false;
-            }
-        }
+    // control frames are not held back
+    if(ret && (opcode & 0x08)) {
+        ret = flushWrites(client);
     }
 
     DEBUG_WEBSOCKETS("[WS][%d][sendFrame] sending Frame Done (%luus).\n", client->num, (micros() - start));
 
-#ifdef WEBSOCKETS_USE_BIG_MEM
-    if(useInternBuffer && payloadPtr) {
-        free(payloadPtr);
+    return ret;
+}
+
+/**
+ * send one frame with a payload made of several slices, the slices are not copied to one buffer first
+ * the payload is send unmasked (mask key 0) since the slices may not be modified
+ * @param client WSclient_t *   ptr to the client struct
+ * @param opcode WSopcode_t
+ * @param slices WSslice_t *    parts of the payload in order
+ * @param count size_t          number of slices, max WEBSOCKETS_MAX_SLICES
+ * @param fin bool              can be used to send data in more then one frame (set fin on the last frame)
+ * @return true if ok
+ */
+bool WebSockets::sendFrameSlices(WSclient_t * client, WSopcode_t opcode, const WSslice_t * slices, size_t count, bool fin) {
+    if(client->tcp && !client->tcp->connected()) {
+        DEBUG_WEBSOCKETS("[WS][%d][sendFrameSlices] not Connected!?\n", client->num);
+        return false;
+    }
+
+    if(client->status != WSC_CONNECTED) {
+        DEBUG_WEBSOCKETS("[WS][%d][sendFrameSlices] not in WSC_CONNECTED state!?\n", client->num);
+        return false;
     }
-#endif
 
-    return ret;
+    if(count > WEBSOCKETS_MAX_SLICES) {
+        DEBUG_WEBSOCKETS("[WS][%d][sendFrameSlices] to many slices (%u)!\n", client->num, count);
+        return false;
+    }
+
+    uint8_t maskKey[4]                         = { 0x00, 0x00, 0x00, 0x00 };
+    uint8_t buffer[WEBSOCKETS_MAX_HEADER_SIZE] = { 0 };
+    WSslice_t frame[WEBSOCKETS_MAX_SLICES + 1];
+
+    size_t length = 0;
+    for(size_t i = 0; i < count; i++) {
+        frame[i + 1] = slices[i];
+        length += slices[i].length;
+    }
+
+    uint8_t headerSize = createHeader(&buffer[0], opcode, length, client->cIsClient, maskKey, fin);
+    frame[0].data      = &buffer[0];
+    frame[0].length    = headerSize;
+
+    return (writeSlices(client, frame, count + 1) == (headerSize + length));
 }
 
 /**
@@ -321,8 +445,14 @@ bool WebSockets::sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * pay
  * @param client WSclient_t *  ptr to the client struct
  */
 void WebSockets::headerDone(WSclient_t * client) {
-    client->status    = WSC_CONNECTED;
-    client->cWsRXsize = 0;
+    client->status             = WSC_CONNECTED;
+    client->cWsRXsize          = 0;
+    client->cWsPayloadPending  = false;
+    client->cWsPayloadReceived = 0;
+    client->cWsPayloadStream   = false;
+    // allocate the transmit buffer now while the heap is still in one piece
+    reserveTxBuffer(client, 0);
+    applyWriteMode(client);
     DEBUG_WEBSOCKETS("[WS][%d][headerDone] Header Handling Done.\n", client->num);
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     client->cHttpLine = "";
@@ -335,9 +465,14 @@ void WebSockets::headerDone(WSclient_t * client) {
  * @param client WSclient_t *  ptr to the client struct
  */
 void WebSockets::handleWebsocket(WSclient_t * client) {
+#if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     if(client->cWsRXsize == 0) {
         handleWebsocketCb(client);
     }
+#else
+    // the parser continues where it stopped on the last call
+    handleWebsocketCb(client);
+#endif
 }
 
 /**
@@ -360,6 +495,11 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
     }
 
     DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor] size: %d cWsRXsize: %d\n", client->num, size, client->cWsRXsize);
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    // take what is there, the header is decoded again on the next call when the rest arrived
+    client->cWsRXsize += readAvailable(client, &client->cWsHeader[client->cWsRXsize], (size - client->cWsRXsize));
+    return (client->cWsRXsize >= size);
+#else
     readCb(client, &client->cWsHeader[client->cWsRXsize], (size - client->cWsRXsize), std::bind([](WebSockets * server, size_t size, WSclient_t * client, bool ok) {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketWaitFor][readCb] size: %d ok: %d\n", client->num, size, ok);
         if(ok) {
@@ -374,6 +514,7 @@ bool WebSockets::handleWebsocketWaitFor(WSclient_t * client, size_t size) {
     },
                                                                                           this, size, std::placeholders::_1, std::placeholders::_2));
     return false;
+#endif
 }
 
 void WebSockets::handleWebsocketCb(WSclient_t * client) {
@@ -381,6 +522,13 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
         return;
     }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    if(client->cWsPayloadPending) {
+        handleWebsocketPayloadRead(client);
+        return;
+    }
+#endif
+
     uint8_t * buffer = client->cWsHeader;
 
     WSMessageHeader_t * header = &client->cWsHeaderDecode;
@@ -431,7 +579,18 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
     DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] fin: %u rsv1: %u rsv2: %u rsv3 %u  opCode: %u\n", client->num, header->fin, header->rsv1, header->rsv2, header->rsv3, header->opCode);
     DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] mask: %u payloadLen: %u\n", client->num, header->mask, header->payloadLen);
 
-    if(header->payloadLen > WEBSOCKETS_MAX_DATA_SIZE) {
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    // large data frames go to the stream callback in chunks, so they do not need to fit WEBSOCKETS_MAX_DATA_SIZE
+    bool stream = streamEnabled() && !header->rsv1 && (header->payloadLen > WEBSOCKETS_STREAM_CHUNK_SIZE) && (header->opCode == WSop_text || header->opCode == WSop_binary || header->opCode == WSop_continuation);
+    if(_reassemblySize && (!header->fin || header->opCode == WSop_continuation)) {
+        // fragments of a message that is reassembled are never streamed
+        stream = false;
+    }
+#else
+    bool stream = false;
+#endif
+
+    if(!stream && header->payloadLen > WEBSOCKETS_MAX_DATA_SIZE) {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] payload too big! (%u)\n", client->num, header->payloadLen);
         clientDisconnect(client, 1009);
         return;
@@ -448,14 +607,22 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
 
     if(header->payloadLen > 0) {
         // if text data we need one more
-        payload = (uint8_t *)malloc(header->payloadLen + 1);
+        payload = reserveRxBuffer(client, (stream ? WEBSOCKETS_STREAM_CHUNK_SIZE : header->payloadLen) + 1);
 
         if(!payload) {
             DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] to less memory to handle payload %d!\n", client->num, header->payloadLen);
-            clientDisconnect(client, 1011);
+            // a fixed buffer of the user is to small for the message, otherwise the heap is exhausted
+            clientDisconnect(client, client->cRxBufferStatic ? 1009 : 1011);
             return;
         }
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+        client->cWsPayloadPending  = true;
+        client->cWsPayloadReceived = 0;
+        client->cWsPayloadStream   = stream;
+        handleWebsocketPayloadRead(client);
+#else
         readCb(client, payload, header->payloadLen, std::bind(&WebSockets::handleWebsocketPayloadCb, this, std::placeholders::_1, std::placeholders::_2, payload));
+#endif
     } else {
         handleWebsocketPayloadCb(client, true, NULL);
     }
@@ -463,46 +630,96 @@ void WebSockets::handleWebsocketCb(WSclient_t * client) {
 
 void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t * payload) {
     WSMessageHeader_t * header = &client->cWsHeaderDecode;
+    size_t length              = header->payloadLen;
     if(ok) {
         if(header->payloadLen > 0) {
             payload[header->payloadLen] = 0x00;
 
             if(header->mask) {
                 //decode XOR
-                for(size_t i = 0; i < header->payloadLen; i++) {
-                    payload[i] = (payload[i] ^ header->maskKey[i % 4]);
-                }
+                maskPayload(payload, header->payloadLen, header->maskKey);
+            }
+        }
+
+        WSopcode_t opcode = header->opCode;
+        bool fin          = header->fin;
+        bool compressed   = header->rsv1;
+        size_t maxLength  = WEBSOCKETS_MAX_DATA_SIZE;
+
+        // RSV1 marks a message compressed with permessage-deflate, it is only set on the first frame
+        if(compressed && (!client->cDeflate || (opcode != WSop_text && opcode != WSop_binary))) {
+            DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] RSV1 set without permessage-deflate!\n", client->num);
+            clientDisconnect(client, 1002);
+            return;
+        }
+
+        if(_reassemblySize && (opcode == WSop_continuation || ((opcode == WSop_text || opcode == WSop_binary) && !fin))) {
+            if(!reassembleFragment(client, header, payload, length)) {
+                return;
+            }
+            if(fin) {
+                // deliver the whole message like a single frame
+                opcode     = client->cMessageOpcode;
+                compressed = client->cMessageCompressed;
+                payload    = client->cMessageBuffer;
+                length     = client->cMessageLength;
+                maxLength  = _reassemblySize;
+
+                client->cMessageOpcode = WSop_close;
+            } else {
+                opcode = WSop_continuation;
+            }
+        } else if(_reassemblySize && client->cMessageOpcode != WSop_close && (opcode == WSop_text || opcode == WSop_binary)) {
+            DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] new message before the end of the fragmented message!\n", client->num);
+            clientDisconnect(client, 1002);
+            return;
+        }
+
+        if(compressed && fin) {
+            payload = inflatePayload(client, payload, &length, maxLength);
+            if(!payload) {
+                return;
             }
+        } else if(compressed && !_reassemblySize) {
+            DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] fragmented compressed messages need reassembly!\n", client->num);
+            clientDisconnect(client, 1003);
+            return;
         }
 
-        switch(header->opCode) {
+        switch(opcode) {
             case WSop_text:
                 DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] text: %s\n", client->num, payload);
                 // no break here!
             case WSop_binary:
+                messageReceived(client, opcode, payload, length, fin);
+                break;
             case WSop_continuation:
-                messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
+                if(_reassemblySize) {
+                    // the fragment is kept until the message is complete
+                    break;
+                }
+                messageReceived(client, opcode, payload, length, fin);
                 break;
             case WSop_ping:
                 // send pong back
                 DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] ping received (%s)\n", client->num, payload ? (const char *)payload : "");
-                sendFrame(client, WSop_pong, payload, header->payloadLen);
-                messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
+                sendFrame(client, WSop_pong, payload, length);
+                messageReceived(client, header->opCode, payload, length, header->fin);
                 break;
             case WSop_pong:
                 DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] get pong (%s)\n", client->num, payload ? (const char *)payload : "");
                 client->pongReceived = true;
-                messageReceived(client, header->opCode, payload, header->payloadLen, header->fin);
+                messageReceived(client, header->opCode, payload, length, header->fin);
                 break;
             case WSop_close: {
 #ifndef NODEBUG_WEBSOCKETS
                 uint16_t reasonCode = 1000;
-                if(header->payloadLen >= 2) {
+                if(length >= 2) {
                     reasonCode = payload[0] << 8 | payload[1];
                 }
 #endif
                 DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] get ask for close. Code: %d\n", client->num, reasonCode);
-                if(header->payloadLen > 2) {
+                if(length > 2) {
                     DEBUG_WEBSOCKETS(" (%s)\n", (payload + 2));
                 } else {
                     DEBUG_WEBSOCKETS("\n");
@@ -515,10 +732,6 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
                 break;
         }
 
-        if(payload) {
-            free(payload);
-        }
-
         // reset input
         client->cWsRXsize = 0;
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
@@ -528,11 +741,556 @@ void WebSockets::handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t
 
     } else {
         DEBUG_WEBSOCKETS("[WS][%d][handleWebsocket] missing data!\n", client->num);
-        free(payload);
         clientDisconnect(client, 1002);
     }
 }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+/**
+ * read the part of the payload that is available, the frame is handled when the payload is complete
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::handleWebsocketPayloadRead(WSclient_t * client) {
+    WSMessageHeader_t * header = &client->cWsHeaderDecode;
+
+    if(client->cWsPayloadStream) {
+        // hand over every chunk as it arrives
+        size_t offset = client->cWsPayloadReceived;
+        size_t left   = header->payloadLen - offset;
+        size_t length = readAvailable(client, client->cRxBuffer, (left < WEBSOCKETS_STREAM_CHUNK_SIZE ? left : WEBSOCKETS_STREAM_CHUNK_SIZE));
+        if(length == 0) {
+            return;
+        }
+
+        client->cRxBuffer[length] = 0x00;
+        if(header->mask) {
+            maskPayload(client->cRxBuffer, length, header->maskKey, offset);
+        }
+
+        client->cWsPayloadReceived += length;
+        if(client->cWsPayloadReceived == header->payloadLen) {
+            // frame done, reset input before the callback so it may send or disconnect
+            client->cWsPayloadPending = false;
+            client->cWsPayloadStream  = false;
+            client->cWsRXsize         = 0;
+        }
+
+        messageStream(client, header->opCode, client->cRxBuffer, length, offset, header->payloadLen, header->fin);
+        return;
+    }
+
+    client->cWsPayloadReceived += readAvailable(client, client->cRxBuffer + client->cWsPayloadReceived, (header->payloadLen - client->cWsPayloadReceived));
+    if(client->cWsPayloadReceived < header->payloadLen) {
+        return;
+    }
+
+    client->cWsPayloadPending = false;
+    handleWebsocketPayloadCb(client, true, client->cRxBuffer);
+}
+
+/**
+ * disconnect when a frame stopped arriving halfway, call while no data is available
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::handleWebsocketTimeout(WSclient_t * client) {
+    if(client->cWsRXsize == 0 && !client->cWsPayloadPending) {
+        return;
+    }
+
+    if((millis() - client->cWsLastReceive) > WEBSOCKETS_TCP_TIMEOUT) {
+        DEBUG_WEBSOCKETS("[WS][%d][handleWebsocketTimeout] receive TIMEOUT! frame incomplete\n", client->num);
+        clientDisconnect(client, 1002);
+    }
+}
+#endif
+
+/**
+ * event type of a data frame
+ * @param opcode WSopcode_t  opcode of the frame
+ * @param fin bool           last frame of the message
+ * @return WStype_t
+ */
+WStype_t WebSockets::dataFrameType(WSopcode_t opcode, bool fin) {
+    switch(opcode) {
+        case WSop_text:
+            return fin ? WStype_TEXT : WStype_FRAGMENT_TEXT_START;
+        case WSop_binary:
+            return fin ? WStype_BIN : WStype_FRAGMENT_BIN_START;
+        case WSop_continuation:
+            return fin ? WStype_FRAGMENT_FIN : WStype_FRAGMENT;
+        default:
+            return WStype_ERROR;
+    }
+}
+
+/**
+ * send a message in frames of max _fragmentSize payload
+ * @param client WSclient_t *   ptr to the client struct
+ * @param opcode WSopcode_t     WSop_text or WSop_binary
+ * @param payload uint8_t *     ptr to the payload, without header room
+ * @param length size_t         length of the payload
+ * @return true if ok
+ */
+bool WebSockets::sendFragments(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length) {
+    size_t offset = 0;
+
+    DEBUG_WEBSOCKETS("[WS][%d][sendFragments] %u byte in frames of %u\n", client->num, length, _fragmentSize);
+
+    while(offset < length) {
+        size_t size = length - offset;
+        if(size > _fragmentSize) {
+            size = _fragmentSize;
+        }
+
+        // every frame is copied to the transmit buffer, so the peak memory is the fragment size
+        if(!sendFrame(client, (offset == 0) ? opcode : WSop_continuation, payload + offset, size, (offset + size) == length)) {
+            return false;
+        }
+        offset += size;
+    }
+
+    return true;
+}
+
+/**
+ * append a received fragment to the message that is reassembled
+ * @param client WSclient_t *          ptr to the client struct
+ * @param header WSMessageHeader_t *   header of the fragment
+ * @param payload uint8_t *            unmasked payload of the fragment
+ * @param length size_t                length of the payload
+ * @return false if the client is disconnected
+ */
+bool WebSockets::reassembleFragment(WSclient_t * client, WSMessageHeader_t * header, uint8_t * payload, size_t length) {
+    if(header->opCode == WSop_continuation) {
+        if(client->cMessageOpcode == WSop_close) {
+            DEBUG_WEBSOCKETS("[WS][%d][reassembleFragment] continuation without a message!\n", client->num);
+            clientDisconnect(client, 1002);
+            return false;
+        }
+    } else {
+        if(client->cMessageOpcode != WSop_close) {
+            DEBUG_WEBSOCKETS("[WS][%d][reassembleFragment] new message before the end of the fragmented message!\n", client->num);
+            clientDisconnect(client, 1002);
+            return false;
+        }
+        client->cMessageOpcode     = header->opCode;
+        client->cMessageCompressed = header->rsv1;
+        client->cMessageLength     = 0;
+    }
+
+    size_t needed = client->cMessageLength + length;
+    if(needed > _reassemblySize) {
+        DEBUG_WEBSOCKETS("[WS][%d][reassembleFragment] message too big! (%u)\n", client->num, needed);
+        clientDisconnect(client, 1009);
+        return false;
+    }
+
+    // one more for the zero termination of text messages
+    if(needed + 1 > client->cMessageBufferSize) {
+        size_t size = ((needed + 1 + WEBSOCKETS_RX_BUFFER_STEP - 1) / WEBSOCKETS_RX_BUFFER_STEP) * WEBSOCKETS_RX_BUFFER_STEP;
+        if(size > _reassemblySize + 1) {
+            size = _reassemblySize + 1;
+        }
+
+        uint8_t * buffer = (uint8_t *)realloc(client->cMessageBuffer, size);
+        client->cRxAllocations++;
+        if(!buffer) {
+            DEBUG_WEBSOCKETS("[WS][%d][reassembleFragment] to less memory for the message %u!\n", client->num, size);
+            clientDisconnect(client, 1011);
+            return false;
+        }
+        client->cMessageBuffer     = buffer;
+        client->cMessageBufferSize = size;
+    }
+
+    if(length > 0) {
+        memcpy(client->cMessageBuffer + client->cMessageLength, payload, length);
+    }
+    client->cMessageLength         = needed;
+    client->cMessageBuffer[needed] = 0x00;
+
+    return true;
+}
+
+/**
+ * free the reassembly buffer and drop a partial message
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::releaseMessageBuffer(WSclient_t * client) {
+    free(client->cMessageBuffer);
+    client->cMessageBuffer     = NULL;
+    client->cMessageBufferSize = 0;
+    client->cMessageLength     = 0;
+    client->cMessageOpcode     = WSop_close;
+    client->cMessageCompressed = false;
+}
+
+/**
+ * enable permessage-deflate for the next connections
+ * @param windowBits uint8_t     window size 2^windowBits (9 - 15), 0 disables the extension
+ * @param contextTakeover bool  keep the compression context between messages, needs a window of 2^windowBits per direction
+ */
+void WebSockets::enableDeflate(uint8_t windowBits, bool contextTakeover) {
+    // zlib does not support a window of 8 bits
+    if(windowBits != 0 && windowBits < 9) {
+        windowBits = 9;
+    }
+    if(windowBits > 15) {
+        windowBits = 15;
+    }
+    _deflateWindowBits = windowBits;
+    _deflateTakeover   = contextTakeover;
+}
+
+/**
+ * get the value of a permessage-deflate parameter
+ * @param extension String &  extension header
+ * @param name const char *   parameter name
+ * @return -1 if the parameter is missing, 0 if it has no value, the value otherwise
+ */
+int WebSockets::extensionParam(const String & extension, const char * name) {
+    int index = extension.indexOf(name);
+    if(index < 0) {
+        return -1;
+    }
+
+    index += strlen(name);
+    if(index >= (int)extension.length() || extension[index] != '=') {
+        return 0;
+    }
+
+    index++;
+    if(index < (int)extension.length() && extension[index] == '"') {
+        index++;
+    }
+    return extension.substring(index).toInt();
+}
+
+/**
+ * Sec-WebSocket-Extensions offer of the client
+ * @return String
+ */
+String WebSockets::deflateOffer(void) {
+    String offer = WEBSOCKETS_STRING("permessage-deflate; client_max_window_bits=");
+    offer += String(_deflateWindowBits);
+    offer += WEBSOCKETS_STRING("; server_max_window_bits=");
+    offer += String(_deflateWindowBits);
+    if(!_deflateTakeover) {
+        offer += WEBSOCKETS_STRING("; client_no_context_takeover; server_no_context_takeover");
+    }
+    return offer;
+}
+
+/**
+ * check the Sec-WebSocket-Extensions response of the server to the offer of deflateOffer
+ * @param client WSclient_t *  ptr to the client struct
+ * @return false if the response is invalid and the connection has to fail
+ */
+bool WebSockets::deflateResponse(WSclient_t * client) {
+    const String & response = client->cExtensions;
+    if(response.indexOf(WEBSOCKETS_STRING("permessage-deflate")) < 0) {
+        DEBUG_WEBSOCKETS("[WS][%d][deflateResponse] server does not support permessage-deflate\n", client->num);
+        return true;
+    }
+
+    int serverBits      = extensionParam(response, "server_max_window_bits");
+    int clientBits      = extensionParam(response, "client_max_window_bits");
+    bool serverTakeover = extensionParam(response, "server_no_context_takeover") < 0;
+    bool clientTakeover = extensionParam(response, "client_no_context_takeover") < 0 && _deflateTakeover;
+
+    if(serverBits > _deflateWindowBits || clientBits > _deflateWindowBits || (serverTakeover && !_deflateTakeover)) {
+        DEBUG_WEBSOCKETS("[WS][%d][deflateResponse] invalid response: %s\n", client->num, response.c_str());
+        return false;
+    }
+
+    uint8_t deflateBits = (clientBits >= 8) ? clientBits : _deflateWindowBits;
+    uint8_t inflateBits = (serverBits >= 8) ? serverBits : _deflateWindowBits;
+    return deflateInit(client, deflateBits, clientTakeover, inflateBits, serverTakeover);
+}
+
+/**
+ * accept the first permessage-deflate offer of a client
+ * @param client WSclient_t *  ptr to the client struct, cExtensions holds the offer
+ * @param response String &    Sec-WebSocket-Extensions response
+ * @return true if the extension is accepted
+ */
+bool WebSockets::deflateAccept(WSclient_t * client, String & response) {
+    // offers are separated by ',' in order of preference
+    int start = client->cExtensions.indexOf(WEBSOCKETS_STRING("permessage-deflate"));
+    if(start < 0) {
+        return false;
+    }
+    int end      = client->cExtensions.indexOf(',', start);
+    String offer = client->cExtensions.substring(start, end);
+
+    int serverBits = extensionParam(offer, "server_max_window_bits");
+    int clientBits = extensionParam(offer, "client_max_window_bits");
+    if((serverBits > 0 && serverBits < 8) || serverBits > 15 || (clientBits > 0 && clientBits < 8) || clientBits > 15) {
+        return false;
+    }
+
+    response = WEBSOCKETS_STRING("permessage-deflate");
+
+    // messages we send
+    uint8_t deflateBits  = _deflateWindowBits;
+    bool deflateTakeover = _deflateTakeover && extensionParam(offer, "server_no_context_takeover") < 0;
+    if(serverBits > 0) {
+        if(serverBits < deflateBits) {
+            deflateBits = serverBits;
+        }
+        response += WEBSOCKETS_STRING("; server_max_window_bits=");
+        response += String(deflateBits);
+    }
+    if(!deflateTakeover) {
+        response += WEBSOCKETS_STRING("; server_no_context_takeover");
+    }
+
+    // messages we receive, the window of the client can only be limited if it supports client_max_window_bits
+    uint8_t inflateBits  = _deflateWindowBits;
+    bool inflateTakeover = _deflateTakeover && extensionParam(offer, "client_no_context_takeover") < 0 && clientBits >= 0;
+    if(inflateTakeover) {
+        if(clientBits > 0 && clientBits < inflateBits) {
+            inflateBits = clientBits;
+        }
+        response += WEBSOCKETS_STRING("; client_max_window_bits=");
+        response += String(inflateBits);
+    } else {
+        response += WEBSOCKETS_STRING("; client_no_context_takeover");
+    }
+
+    return deflateInit(client, deflateBits, deflateTakeover, inflateBits, inflateTakeover);
+}
+
+/**
+ * set up permessage-deflate for a connection
+ * @param client WSclient_t *     ptr to the client struct
+ * @param deflateBits uint8_t     window bits of the messages we send
+ * @param deflateTakeover bool    keep the context of the messages we send
+ * @param inflateBits uint8_t     window bits of the messages we receive
+ * @param inflateTakeover bool    the peer keeps the context of the messages it sends
+ * @return false if there is not enough memory for the windows
+ */
+bool WebSockets::deflateInit(WSclient_t * client, uint8_t deflateBits, bool deflateTakeover, uint8_t inflateBits, bool inflateTakeover) {
+    releaseDeflate(client);
+
+    client->cDeflateWindowBits = deflateBits;
+    client->cInflateWindowBits = inflateBits;
+
+    if(deflateTakeover) {
+        client->cDeflateWindow = (uint8_t *)malloc((size_t)1 << deflateBits);
+    }
+    if(inflateTakeover) {
+        client->cInflateWindow = (uint8_t *)malloc((size_t)1 << inflateBits);
+    }
+
+    if((deflateTakeover && !client->cDeflateWindow) || (inflateTakeover && !client->cInflateWindow)) {
+        DEBUG_WEBSOCKETS("[WS][%d][deflateInit] to less memory for the windows!\n", client->num);
+        releaseDeflate(client);
+        return false;
+    }
+
+    client->cDeflate = true;
+    DEBUG_WEBSOCKETS("[WS][%d][deflateInit] deflate bits: %u takeover: %u inflate bits: %u takeover: %u\n", client->num, deflateBits, deflateTakeover, inflateBits, inflateTakeover);
+    return true;
+}
+
+/**
+ * free the permessage-deflate windows and buffer
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::releaseDeflate(WSclient_t * client) {
+    free(client->cDeflateWindow);
+    free(client->cInflateWindow);
+    free(client->cInflateBuffer);
+
+    client->cDeflate           = false;
+    client->cDeflateWindow     = NULL;
+    client->cDeflateWindowFill = 0;
+    client->cInflateWindow     = NULL;
+    client->cInflateWindowFill = 0;
+    client->cInflateBuffer     = NULL;
+    client->cInflateBufferSize = 0;
+}
+
+/**
+ * decompress a received message, the buffer grows like the receive buffer up to maxLength
+ * @param client WSclient_t *  ptr to the client struct
+ * @param payload uint8_t *    compressed message
+ * @param length size_t *      length of the compressed message, set to the length of the message
+ * @param maxLength size_t     max length of the message
+ * @return ptr to the message or NULL if the client is disconnected
+ */
+uint8_t * WebSockets::inflatePayload(WSclient_t * client, uint8_t * payload, size_t * length, size_t maxLength) {
+    size_t size = client->cInflateBufferSize;
+    if(size < (*length * 2) + 1) {
+        size = (((*length * 2) + 1 + WEBSOCKETS_RX_BUFFER_STEP - 1) / WEBSOCKETS_RX_BUFFER_STEP) * WEBSOCKETS_RX_BUFFER_STEP;
+    }
+
+    int32_t result;
+    while(true) {
+        if(size > maxLength + 1) {
+            size = maxLength + 1;
+        }
+
+        if(size > client->cInflateBufferSize) {
+            free(client->cInflateBuffer);
+            client->cInflateBuffer     = (uint8_t *)malloc(size);
+            client->cInflateBufferSize = client->cInflateBuffer ? size : 0;
+            client->cRxAllocations++;
+            if(!client->cInflateBuffer) {
+                DEBUG_WEBSOCKETS("[WS][%d][inflatePayload] to less memory to inflate %u!\n", client->num, size);
+                clientDisconnect(client, 1011);
+                return NULL;
+            }
+        }
+
+        result = wsdeflate_inflate(payload, *length, client->cInflateBuffer, size - 1, client->cInflateWindow, client->cInflateWindowFill);
+        if(result != WSDEFLATE_OVERFLOW || size >= maxLength + 1) {
+            break;
+        }
+        size *= 2;
+    }
+
+    if(result < 0) {
+        DEBUG_WEBSOCKETS("[WS][%d][inflatePayload] inflate failed (%d)\n", client->num, result);
+        clientDisconnect(client, (result == WSDEFLATE_OVERFLOW) ? 1009 : 1007);
+        return NULL;
+    }
+
+    DEBUG_WEBSOCKETS("[WS][%d][inflatePayload] inflate %u -> %d\n", client->num, *length, result);
+
+    if(client->cInflateWindow) {
+        updateDeflateWindow(client->cInflateWindow, &client->cInflateWindowFill, client->cInflateWindowBits, client->cInflateBuffer, result);
+    }
+
+    client->cInflateBuffer[result] = 0x00;
+    *length                        = result;
+    return client->cInflateBuffer;
+}
+
+/**
+ * keep the last 2^windowBits byte of the messages as history for context takeover
+ * @param window uint8_t *      history
+ * @param fill size_t *         used part of the history
+ * @param windowBits uint8_t    size of the history
+ * @param data const uint8_t *  message
+ * @param length size_t         length of the message
+ */
+void WebSockets::updateDeflateWindow(uint8_t * window, size_t * fill, uint8_t windowBits, const uint8_t * data, size_t length) {
+    size_t windowSize = (size_t)1 << windowBits;
+
+    if(length >= windowSize) {
+        memcpy(window, data + length - windowSize, windowSize);
+        *fill = windowSize;
+        return;
+    }
+
+    size_t keep = windowSize - length;
+    if(keep > *fill) {
+        keep = *fill;
+    }
+    memmove(window, window + *fill - keep, keep);
+    memcpy(window + keep, data, length);
+    *fill = keep + length;
+}
+
+/**
+ * get the receive buffer of the client with room for size bytes
+ * the buffer is reused for every frame and only grows, so after the largest frame no allocations are done anymore
+ * @param client WSclient_t *  ptr to the client struct
+ * @param size size_t          needed size
+ * @return ptr to the buffer or NULL if there is not enough memory
+ */
+uint8_t * WebSockets::reserveRxBuffer(WSclient_t * client, size_t size) {
+    if(size <= client->cRxBufferSize) {
+        return client->cRxBuffer;
+    }
+
+    if(client->cRxBufferStatic) {
+        DEBUG_WEBSOCKETS("[WS][%d][reserveRxBuffer] static buffer to small (%u < %u)\n", client->num, client->cRxBufferSize, size);
+        return NULL;
+    }
+
+    // round up so small growing frames do not allocate every time
+    size_t newSize = (size + WEBSOCKETS_RX_BUFFER_STEP - 1) / WEBSOCKETS_RX_BUFFER_STEP * WEBSOCKETS_RX_BUFFER_STEP;
+    if(newSize > WEBSOCKETS_MAX_DATA_SIZE + 1) {
+        newSize = WEBSOCKETS_MAX_DATA_SIZE + 1;
+    }
+
+    // no realloc, the old content is not needed
+    free(client->cRxBuffer);
+    client->cRxBuffer     = (uint8_t *)malloc(newSize);
+    client->cRxBufferSize = client->cRxBuffer ? newSize : 0;
+    client->cRxAllocations++;
+
+    DEBUG_WEBSOCKETS("[WS][%d][reserveRxBuffer] grown to %u (allocations: %u heap fragmentation: %u%%)\n", client->num, client->cRxBufferSize, client->cRxAllocations, GET_HEAP_FRAGMENTATION);
+
+    return client->cRxBuffer;
+}
+
+/**
+ * use a buffer of the user as receive buffer, frames that do not fit are rejected
+ * @param client WSclient_t *  ptr to the client struct
+ * @param buffer uint8_t *     ptr to the buffer, NULL goes back to the allocated buffer
+ * @param size size_t          size of the buffer, one byte is needed for the terminating zero
+ */
+void WebSockets::setRxBuffer(WSclient_t * client, uint8_t * buffer, size_t size) {
+    if(!client->cRxBufferStatic) {
+        free(client->cRxBuffer);
+    }
+
+    client->cRxBuffer       = buffer;
+    client->cRxBufferSize   = buffer ? size : 0;
+    client->cRxBufferStatic = (buffer != NULL);
+}
+
+/**
+ * free the receive buffer, a static buffer of the user is kept
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::releaseRxBuffer(WSclient_t * client) {
+    if(client->cRxBufferStatic) {
+        return;
+    }
+
+    free(client->cRxBuffer);
+    client->cRxBuffer     = NULL;
+    client->cRxBufferSize = 0;
+}
+
+/**
+ * get the payload part of the transmit buffer, the header is added in front of it by sendFrame
+ * the buffer is allocated once and kept until the client disconnects
+ * @param client WSclient_t *  ptr to the client struct
+ * @param length size_t        length of the payload
+ * @return ptr to the payload or NULL if the payload does not fit
+ */
+uint8_t * WebSockets::reserveTxBuffer(WSclient_t * client, size_t length) {
+    if(length > WEBSOCKETS_TX_BUFFER_SIZE || WEBSOCKETS_TX_BUFFER_SIZE == 0) {
+        return NULL;
+    }
+
+    if(!client->cTxBuffer) {
+        client->cTxBuffer = (uint8_t *)malloc(WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKETS_TX_BUFFER_SIZE);
+        if(!client->cTxBuffer) {
+            DEBUG_WEBSOCKETS("[WS][%d][reserveTxBuffer] to less memory for the tx buffer!\n", client->num);
+            return NULL;
+        }
+        DEBUG_WEBSOCKETS("[WS][%d][reserveTxBuffer] allocated %u (heap fragmentation: %u%%)\n", client->num, WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKETS_TX_BUFFER_SIZE, GET_HEAP_FRAGMENTATION);
+    }
+
+    return client->cTxBuffer + WEBSOCKETS_MAX_HEADER_SIZE;
+}
+
+/**
+ * free the transmit buffer
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::releaseTxBuffer(WSclient_t * client) {
+    free(client->cTxBuffer);
+    client->cTxBuffer = NULL;
+}
+
 /**
  * generate the key for Sec-WebSocket-Accept
  * @param clientKey String
@@ -656,18 +1414,84 @@ bool WebSockets::readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWait
     return true;
 }
 
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
 /**
- * write x byte to tcp or get timeout
+ * read up to n byte that are available without waiting
+ * @param client WSclient_t *
+ * @param out  uint8_t * data buffer
+ * @param n size_t max byte count
+ * @return bytes read
+ */
+size_t WebSockets::readAvailable(WSclient_t * client, uint8_t * out, size_t n) {
+    if(!client->tcp || !client->tcp->connected() || n == 0) {
+        return 0;
+    }
+
+    int available = client->tcp->available();
+    if(available <= 0) {
+        return 0;
+    }
+
+    if((size_t)available < n) {
+        n = available;
+    }
+
+    int len = client->tcp->read(out, n);
+    if(len <= 0) {
+        return 0;
+    }
+
+    client->cWsLastReceive = millis();
+    return len;
+}
+#endif
+
+/**
+ * write x byte, in WSwrite_throughput mode they are collected in the write buffer first
  * @param client WSclient_t *
  * @param out  uint8_t * data buffer
  * @param n size_t byte count
- * @return bytes send
+ * @return bytes send or collected
  */
 size_t WebSockets::write(WSclient_t * client, uint8_t * out, size_t n) {
     if(out == NULL)
         return 0;
     if(client == NULL)
         return 0;
+
+    if(client->cWriteBuffer) {
+        if(client->cWriteBufferUsed + n > _writeThreshold && !flushWrites(client)) {
+            return 0;
+        }
+
+        if(n >= _writeThreshold) {
+            // nothing is pending, no need to copy
+            return tcpWrite(client, out, n);
+        }
+
+        if(client->cWriteBufferUsed == 0) {
+            client->cWriteBufferStart = millis();
+        }
+        memcpy(client->cWriteBuffer + client->cWriteBufferUsed, out, n);
+        client->cWriteBufferUsed += n;
+
+        if(client->cWriteBufferUsed == _writeThreshold) {
+            flushWrites(client);
+        }
+        return n;
+    }
+
+    return tcpWrite(client, out, n);
+}
+
+/**
+ * write x byte to tcp or get timeout
+ * @param client WSclient_t *
+ * @param out  uint8_t * data buffer
+ * @param n size_t byte count
+ * @return bytes send
+ */
+size_t WebSockets::tcpWrite(WSclient_t * client, uint8_t * out, size_t n) {
     unsigned long t = millis();
     size_t len      = 0;
     size_t total    = 0;
@@ -706,6 +1530,81 @@ size_t WebSockets::write(WSclient_t * client, uint8_t * out, size_t n) {
     return total;
 }
 
+/**
+ * write several slices as if they were one buffer
+ * the slices are gathered in the transmit buffer (or a small block on the stack) and written with one write per block,
+ * so a short header is not send in its own TCP package. A slice that is larger than the block is written directly.
+ * @param client WSclient_t *  ptr to the client struct
+ * @param slices WSslice_t *   slices to write in order
+ * @param count size_t         number of slices
+ * @return number of bytes written
+ */
+size_t WebSockets::writeSlices(WSclient_t * client, const WSslice_t * slices, size_t count) {
+    uint8_t stackBlock[WEBSOCKETS_WRITE_STAGING_SIZE];
+    uint8_t * block  = &stackBlock[0];
+    size_t blockSize = sizeof(stackBlock);
+
+    // the transmit buffer can only be used when none of the slices is in it
+    if(client->cTxBuffer) {
+        size_t txSize = WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKETS_TX_BUFFER_SIZE;
+        bool useTx    = true;
+        for(size_t i = 0; i < count; i++) {
+            if(slices[i].data >= client->cTxBuffer && slices[i].data < client->cTxBuffer + txSize) {
+                useTx = false;
+            }
+        }
+        if(useTx) {
+            block     = client->cTxBuffer;
+            blockSize = txSize;
+        }
+    }
+
+    size_t used  = 0;
+    size_t total = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        const uint8_t * data = slices[i].data;
+        size_t length        = slices[i].length;
+
+        if(!data) {
+            continue;
+        }
+
+        while(length > 0) {
+            if(used == 0 && length >= blockSize) {
+                // nothing is pending, no need to copy
+                size_t written = write(client, (uint8_t *)data, length);
+                total += written;
+                if(written != length) {
+                    return total;
+                }
+                break;
+            }
+
+            size_t n = (length < blockSize - used) ? length : (blockSize - used);
+            memcpy(block + used, data, n);
+            used += n;
+            data += n;
+            length -= n;
+
+            if(used == blockSize) {
+                size_t written = write(client, block, used);
+                total += written;
+                if(written != used) {
+                    return total;
+                }
+                used = 0;
+            }
+        }
+    }
+
+    if(used > 0) {
+        total += write(client, block, used);
+    }
+
+    return total;
+}
+
 size_t WebSockets::write(WSclient_t * client, const char * out) {
     if(client == NULL)
         return 0;
@@ -714,6 +1613,61 @@ size_t WebSockets::write(WSclient_t * client, const char * out) {
     return write(client, (uint8_t *)out, strlen(out));
 }
 
+/**
+ * set up the write buffer for the current write mode
+ * Nagle stays disabled in both modes, it would hold back the last part of the collected frames until the ACK
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::applyWriteMode(WSclient_t * client) {
+    if(_writeMode == WSwrite_throughput) {
+        if(!client->cWriteBuffer) {
+            client->cWriteBuffer     = (uint8_t *)malloc(_writeThreshold);
+            client->cWriteBufferUsed = 0;
+            if(!client->cWriteBuffer) {
+                DEBUG_WEBSOCKETS("[WS][%d][applyWriteMode] to less memory for the write buffer, frames are written at once\n", client->num);
+            }
+        }
+    } else {
+        flushWrites(client);
+        releaseWriteBuffer(client);
+    }
+}
+
+/**
+ * write the collected frames
+ * @param client WSclient_t *  ptr to the client struct
+ * @return true if ok
+ */
+bool WebSockets::flushWrites(WSclient_t * client) {
+    if(!client->cWriteBuffer || client->cWriteBufferUsed == 0) {
+        return true;
+    }
+
+    size_t used              = client->cWriteBufferUsed;
+    client->cWriteBufferUsed = 0;
+    return (tcpWrite(client, client->cWriteBuffer, used) == used);
+}
+
+/**
+ * write the collected frames once the oldest one waited _writeTimeout ms
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::handleWriteTimeout(WSclient_t * client) {
+    if(client->cWriteBufferUsed > 0 && (millis() - client->cWriteBufferStart) >= _writeTimeout) {
+        flushWrites(client);
+    }
+}
+
+/**
+ * free the write buffer, collected frames are dropped
+ * @param client WSclient_t *  ptr to the client struct
+ */
+void WebSockets::releaseWriteBuffer(WSclient_t * client) {
+    free(client->cWriteBuffer);
+    client->cWriteBuffer     = NULL;
+    client->cWriteBufferUsed = 0;
+}
+
 /**
  * enable ping/pong heartbeat process
  * @param client WSclient_t *
@@ -60,6 +60,9 @@
 #define WEBSOCKETS_MAX_DATA_SIZE (15 * 1024)
 #define WEBSOCKETS_USE_BIG_MEM
 #define GET_FREE_HEAP ESP.getFreeHeap()
+#if defined(ESP8266)
+#define GET_HEAP_FRAGMENTATION ESP.getHeapFragmentation()
+#endif
 // moves all Header strings to Flash (~300 Byte)
 //#define WEBSOCKETS_SAVE_RAM
 
@@ -88,6 +91,60 @@
 #define WEBSOCKETS_YIELD_MORE()
 #endif
 
+#ifndef GET_HEAP_FRAGMENTATION
+#define GET_HEAP_FRAGMENTATION 0
+#endif
+
+// payload size of the transmit buffer, frames up to this size are send in one TCP package without allocation
+// 0 disables the buffer and header and payload are written separately
+#ifndef WEBSOCKETS_TX_BUFFER_SIZE
+#ifdef WEBSOCKETS_USE_BIG_MEM
+#define WEBSOCKETS_TX_BUFFER_SIZE 1400
+#else
+#define WEBSOCKETS_TX_BUFFER_SIZE 0
+#endif
+#endif
+
+// the receive buffer grows in steps of this size up to WEBSOCKETS_MAX_DATA_SIZE
+#ifndef WEBSOCKETS_RX_BUFFER_STEP
+#define WEBSOCKETS_RX_BUFFER_STEP 64
+#endif
+
+// with a stream callback data frames larger than this are delivered in chunks of this size instead of buffered whole
+#ifndef WEBSOCKETS_STREAM_CHUNK_SIZE
+#define WEBSOCKETS_STREAM_CHUNK_SIZE 256
+#endif
+
+// permessage-deflate defaults, a window of 2^bits byte is kept per direction with context takeover
+#ifndef WEBSOCKETS_DEFLATE_WINDOW_BITS
+#define WEBSOCKETS_DEFLATE_WINDOW_BITS 9
+#endif
+
+// smaller messages are send uncompressed
+#ifndef WEBSOCKETS_DEFLATE_MIN_SIZE
+#define WEBSOCKETS_DEFLATE_MIN_SIZE 32
+#endif
+
+// in WSwrite_throughput mode frames are collected until this many byte are pending, one TCP segment with the default lwIP MSS
+#ifndef WEBSOCKETS_WRITE_COALESCE_SIZE
+#define WEBSOCKETS_WRITE_COALESCE_SIZE 536
+#endif
+
+// in WSwrite_throughput mode collected frames are written after this many ms
+#ifndef WEBSOCKETS_WRITE_COALESCE_TIMEOUT
+#define WEBSOCKETS_WRITE_COALESCE_TIMEOUT 10
+#endif
+
+// max number of payload slices in one frame send with sendFrameSlices
+#ifndef WEBSOCKETS_MAX_SLICES
+#define WEBSOCKETS_MAX_SLICES 4
+#endif
+
+// slices are gathered on the stack in blocks of this size when there is no transmit buffer
+#ifndef WEBSOCKETS_WRITE_STAGING_SIZE
+#define WEBSOCKETS_WRITE_STAGING_SIZE 64
+#endif
+
 #define WEBSOCKETS_TCP_TIMEOUT (5000)
 
 #define NETWORK_ESP8266_ASYNC (0)
@@ -239,6 +296,11 @@ typedef enum {
                                  ///< %xB-F are reserved for further control frames
 } WSopcode_t;
 
+typedef enum {
+    WSwrite_lowLatency,    ///< every frame is written at once
+    WSwrite_throughput     ///< frames are collected until the size threshold, the timeout or flush()
+} WSwriteMode_t;
+
 typedef struct {
     bool fin;
     bool rsv1;
@@ -253,6 +315,11 @@ typedef struct {
     uint8_t * maskKey;
 } WSMessageHeader_t;
 
+typedef struct {
+    const uint8_t * data;    ///< ptr to the data of the slice
+    size_t length;           ///< length of the slice
+} WSslice_t;
+
 typedef struct {
     uint8_t num;    ///< connection number
 
@@ -285,6 +352,38 @@ typedef struct {
     uint8_t cWsHeader[WEBSOCKETS_MAX_HEADER_SIZE];    ///< RX WS Message buffer
     WSMessageHeader_t cWsHeaderDecode;
 
+    bool cWsPayloadPending       = false;    ///< header is decoded, payload is still arriving
+    size_t cWsPayloadReceived    = 0;        ///< payload bytes received of the current frame
+    bool cWsPayloadStream        = false;    ///< payload of the current frame is delivered in chunks
+    unsigned long cWsLastReceive = 0;        ///< millis() of the last byte received of the current frame
+
+    uint8_t * cRxBuffer   = NULL;     ///< receive buffer, reused for every frame
+    size_t cRxBufferSize  = 0;        ///< size of cRxBuffer, grows to the largest frame received
+    bool cRxBufferStatic  = false;    ///< cRxBuffer is supplied by the user and never freed
+    uint32_t cRxAllocations = 0;      ///< number of times cRxBuffer was allocated
+
+    uint8_t * cTxBuffer   = NULL;     ///< transmit buffer, WEBSOCKETS_MAX_HEADER_SIZE for the header followed by WEBSOCKETS_TX_BUFFER_SIZE payload
+
+    bool cDeflate               = false;    ///< permessage-deflate is negotiated
+    uint8_t cDeflateWindowBits  = 15;       ///< window of the messages we compress
+    uint8_t cInflateWindowBits  = 15;       ///< window of the messages we decompress
+    uint8_t * cDeflateWindow    = NULL;     ///< end of the send messages, only with context takeover
+    size_t cDeflateWindowFill   = 0;
+    uint8_t * cInflateWindow    = NULL;     ///< end of the received messages, only with context takeover
+    size_t cInflateWindowFill   = 0;
+    uint8_t * cInflateBuffer    = NULL;     ///< decompressed message, grows like cRxBuffer
+    size_t cInflateBufferSize   = 0;
+
+    uint8_t * cMessageBuffer    = NULL;            ///< fragments of the message that is reassembled
+    size_t cMessageBufferSize   = 0;
+    size_t cMessageLength       = 0;
+    WSopcode_t cMessageOpcode   = WSop_close;      ///< opcode of the first fragment, WSop_close if no message is reassembled
+    bool cMessageCompressed     = false;           ///< RSV1 of the first fragment
+
+    uint8_t * cWriteBuffer          = NULL;    ///< frames collected in WSwrite_throughput mode
+    size_t cWriteBufferUsed         = 0;
+    unsigned long cWriteBufferStart = 0;       ///< millis() of the oldest collected byte
+
     String base64Authorization;    ///< Base64 encoded Auth request
     String plainAuthorization;     ///< Base64 encoded Auth request
 
@@ -321,9 +420,25 @@ class WebSockets {
 
     virtual void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin) = 0;
 
-    uint8_t createHeader(uint8_t * buf, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin);
+    /**
+     * called with the chunks of a streamed data frame, only used when streamEnabled returns true
+     * @param payload uint8_t *  unmasked chunk, zero terminated
+     * @param length size_t      length of the chunk
+     * @param offset size_t      position of the chunk in the frame payload
+     * @param total size_t       length of the frame payload
+     */
+    virtual void messageStream(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, size_t offset, size_t total, bool fin) {
+    }
+    virtual bool streamEnabled(void) {
+        return false;
+    }
+    static WStype_t dataFrameType(WSopcode_t opcode, bool fin);
+
+    uint8_t createHeader(uint8_t * buf, WSopcode_t opcode, size_t length, bool mask, uint8_t maskKey[4], bool fin, bool rsv1 = false);
+    static void maskPayload(uint8_t * data, size_t length, const uint8_t maskKey[4], size_t offset = 0);
     bool sendFrameHeader(WSclient_t * client, WSopcode_t opcode, size_t length = 0, bool fin = true);
     bool sendFrame(WSclient_t * client, WSopcode_t opcode, uint8_t * payload = NULL, size_t length = 0, bool fin = true, bool headerToPayload = false);
+    bool sendFrameSlices(WSclient_t * client, WSopcode_t opcode, const WSslice_t * slices, size_t count, bool fin = true);
 
     void headerDone(WSclient_t * client);
 
@@ -332,16 +447,59 @@ class WebSockets {
     bool handleWebsocketWaitFor(WSclient_t * client, size_t size);
     void handleWebsocketCb(WSclient_t * client);
     void handleWebsocketPayloadCb(WSclient_t * client, bool ok, uint8_t * payload);
+#if(WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
+    void handleWebsocketPayloadRead(WSclient_t * client);
+    void handleWebsocketTimeout(WSclient_t * client);
+    size_t readAvailable(WSclient_t * client, uint8_t * out, size_t n);
+#endif
 
     String acceptKey(String & clientKey);
     String base64_encode(uint8_t * data, size_t length);
 
+    uint8_t * reserveRxBuffer(WSclient_t * client, size_t size);
+    void setRxBuffer(WSclient_t * client, uint8_t * buffer, size_t size);
+    void releaseRxBuffer(WSclient_t * client);
+
+    uint8_t * reserveTxBuffer(WSclient_t * client, size_t length);
+    void releaseTxBuffer(WSclient_t * client);
+
     bool readCb(WSclient_t * client, uint8_t * out, size_t n, WSreadWaitCb cb);
     virtual size_t write(WSclient_t * client, uint8_t * out, size_t n);
     size_t write(WSclient_t * client, const char * out);
+    size_t writeSlices(WSclient_t * client, const WSslice_t * slices, size_t count);
 
     void enableHeartbeat(WSclient_t * client, uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount);
     void handleHBTimeout(WSclient_t * client);
+
+    uint8_t _deflateWindowBits = 0;       ///< permessage-deflate window bits, 0 disables the extension
+    bool _deflateTakeover      = false;    ///< allow context takeover
+
+    void enableDeflate(uint8_t windowBits, bool contextTakeover);
+    String deflateOffer(void);
+    bool deflateResponse(WSclient_t * client);
+    bool deflateAccept(WSclient_t * client, String & response);
+    bool deflateInit(WSclient_t * client, uint8_t deflateBits, bool deflateTakeover, uint8_t inflateBits, bool inflateTakeover);
+    void releaseDeflate(WSclient_t * client);
+    uint8_t * inflatePayload(WSclient_t * client, uint8_t * payload, size_t * length, size_t maxLength);
+    static void updateDeflateWindow(uint8_t * window, size_t * fill, uint8_t windowBits, const uint8_t * data, size_t length);
+    static int extensionParam(const String & extension, const char * name);
+
+    size_t _reassemblySize = 0;    ///< max size of a reassembled message, 0 delivers the fragments
+    size_t _fragmentSize   = 0;    ///< max payload per frame of a send message, 0 sends one frame
+
+    bool reassembleFragment(WSclient_t * client, WSMessageHeader_t * header, uint8_t * payload, size_t length);
+    void releaseMessageBuffer(WSclient_t * client);
+    bool sendFragments(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length);
+
+    WSwriteMode_t _writeMode = WSwrite_lowLatency;
+    size_t _writeThreshold   = WEBSOCKETS_WRITE_COALESCE_SIZE;       ///< size of the write buffer in WSwrite_throughput mode
+    uint32_t _writeTimeout   = WEBSOCKETS_WRITE_COALESCE_TIMEOUT;    ///< max time in ms a frame is held back
+
+    void applyWriteMode(WSclient_t * client);
+    bool flushWrites(WSclient_t * client);
+    void handleWriteTimeout(WSclient_t * client);
+    void releaseWriteBuffer(WSclient_t * client);
+    size_t tcpWrite(WSclient_t * client, uint8_t * out, size_t n);
 };
 
 #ifndef UNUSED
@@ -27,6 +27,7 @@
 
 WebSocketsClient::WebSocketsClient() {
     _cbEvent             = NULL;
+    _cbStream            = NULL;
     _client.num          = 0;
     _client.cIsClient    = true;
     _client.extraHeaders = WEBSOCKETS_STRING("Origin: file://");
@@ -37,6 +38,11 @@ WebSocketsClient::WebSocketsClient() {
 
 WebSocketsClient::~WebSocketsClient() {
     disconnect();
+    WebSockets::setRxBuffer(&_client, NULL, 0);
+    releaseTxBuffer(&_client);
+    releaseDeflate(&_client);
+    releaseMessageBuffer(&_client);
+    releaseWriteBuffer(&_client);
 }
 
 /**
@@ -249,6 +255,7 @@ void WebSocketsClient::loop(void) {
         if(_client.status == WSC_CONNECTED) {
             handleHBPing();
             handleHBTimeout(&_client);
+            handleWriteTimeout(&_client);
         }
     }
 }
@@ -262,6 +269,68 @@ void WebSocketsClient::onEvent(WebSocketClientEvent cbEvent) {
     _cbEvent = cbEvent;
 }
 
+/**
+ * deliver data frames larger than WEBSOCKETS_STREAM_CHUNK_SIZE in chunks instead of as one event
+ * the chunks are unmasked and only valid during the callback
+ * @param cbStream WebSocketClientStreamEvent  called with type, chunk, chunk length, offset in the frame and frame length
+ */
+void WebSocketsClient::onStream(WebSocketClientStreamEvent cbStream) {
+    _cbStream = cbStream;
+}
+
+/**
+ * negotiate permessage-deflate on the next connect
+ * @param windowBits uint8_t     window size 2^windowBits (9 - 15), 0 disables the extension
+ * @param contextTakeover bool  keep the compression context between messages, costs 2 * 2^windowBits byte
+ */
+void WebSocketsClient::enableDeflate(uint8_t windowBits, bool contextTakeover) {
+    WebSockets::enableDeflate(windowBits, contextTakeover);
+}
+
+/**
+ * deliver fragmented messages as one WStype_TEXT / WStype_BIN event instead of the WStype_FRAGMENT events
+ * @param maxSize size_t  max size of a message, bigger messages close the connection with 1009, 0 disables the reassembly
+ */
+void WebSocketsClient::setReassemblySize(size_t maxSize) {
+    _reassemblySize = maxSize;
+}
+
+/**
+ * send text and binary messages bigger than size in several frames of max size byte
+ * @param size size_t  max payload per frame, 0 sends every message in one frame
+ */
+void WebSocketsClient::setFragmentSize(size_t size) {
+    _fragmentSize = size;
+}
+
+/**
+ * choose between writing every frame at once and collecting small frames into one TCP segment
+ * with the async network type there is no loop, so collected frames are only written by flush() and the size threshold
+ * @param mode WSwriteMode_t      WSwrite_lowLatency or WSwrite_throughput
+ * @param threshold size_t        WSwrite_throughput: frames are written once this many byte are collected
+ * @param timeout uint32_t        WSwrite_throughput: frames are written at the latest after this many ms
+ */
+void WebSocketsClient::setWriteMode(WSwriteMode_t mode, size_t threshold, uint32_t timeout) {
+    flushWrites(&_client);
+    releaseWriteBuffer(&_client);
+
+    _writeMode      = mode;
+    _writeThreshold = threshold ? threshold : WEBSOCKETS_WRITE_COALESCE_SIZE;
+    _writeTimeout   = timeout;
+
+    if(_client.status == WSC_CONNECTED) {
+        applyWriteMode(&_client);
+    }
+}
+
+/**
+ * write the frames collected in WSwrite_throughput mode now
+ * @return true if ok
+ */
+bool WebSocketsClient::flush(void) {
+    return flushWrites(&_client);
+}
+
 /**
  * send text data to client
  * @param num uint8_t client id
@@ -321,6 +390,38 @@ bool WebSocketsClient::sendBIN(const uint8_t * payload, size_t length) {
     return sendBIN((uint8_t *)payload, length);
 }
 
+/**
+ * get room in the transmit buffer to build a payload in place, send it with sendReservedTXT or sendReservedBIN
+ * the header is added in front of it, so no copy or allocation is needed
+ * @param length size_t  length of the payload
+ * @return ptr to the payload or NULL if it does not fit WEBSOCKETS_TX_BUFFER_SIZE
+ */
+uint8_t * WebSocketsClient::reservePayload(size_t length) {
+    if(clientIsConnected(&_client)) {
+        return reserveTxBuffer(&_client, length);
+    }
+    return NULL;
+}
+
+/**
+ * send a payload build in the buffer of reservePayload
+ * @param length size_t  length of the payload
+ * @return true if ok
+ */
+bool WebSocketsClient::sendReservedTXT(size_t length) {
+    if(clientIsConnected(&_client) && _client.cTxBuffer && length <= WEBSOCKETS_TX_BUFFER_SIZE) {
+        return sendFrame(&_client, WSop_text, _client.cTxBuffer, length, true, true);
+    }
+    return false;
+}
+
+bool WebSocketsClient::sendReservedBIN(size_t length) {
+    if(clientIsConnected(&_client) && _client.cTxBuffer && length <= WEBSOCKETS_TX_BUFFER_SIZE) {
+        return sendFrame(&_client, WSop_binary, _client.cTxBuffer, length, true, true);
+    }
+    return false;
+}
+
 /**
  * sends a WS ping to Server
  * @param payload uint8_t *
@@ -438,6 +539,18 @@ void WebSocketsClient::messageReceived(WSclient_t * client, WSopcode_t opcode, u
     runCbEvent(type, payload, length);
 }
 
+void WebSocketsClient::messageStream(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, size_t offset, size_t total, bool fin) {
+    UNUSED(client);
+
+    if(_cbStream) {
+        _cbStream(dataFrameType(opcode, fin), payload, length, offset, total);
+    }
+}
+
+bool WebSocketsClient::streamEnabled(void) {
+    return (_cbStream != NULL);
+}
+
 /**
  * Disconnect an client
  * @param client WSclient_t *  ptr to the client struct
@@ -482,6 +595,12 @@ void WebSocketsClient::clientDisconnect(WSclient_t * client) {
     client->cIsWebsocket = false;
     client->cSessionId   = "";
 
+    releaseRxBuffer(client);
+    releaseTxBuffer(client);
+    releaseDeflate(client);
+    releaseMessageBuffer(client);
+    releaseWriteBuffer(client);
+
     client->status = WSC_NOT_CONNECTED;
 
     DEBUG_WEBSOCKETS("[WS-Client] client disconnected.\n");
@@ -490,6 +609,23 @@ void WebSocketsClient::clientDisconnect(WSclient_t * client) {
     }
 }
 
+/**
+ * use a fixed buffer for received frames instead of allocating one, frames that do not fit close the connection with 1009
+ * @param buffer uint8_t *  buffer for the received frames, NULL goes back to the allocated buffer
+ * @param size size_t       size of the buffer, one byte more than the largest payload is needed
+ */
+void WebSocketsClient::setRxBuffer(uint8_t * buffer, size_t size) {
+    WebSockets::setRxBuffer(&_client, buffer, size);
+}
+
+/**
+ * number of times the receive buffer was allocated, stays the same once the largest frame is received
+ * @return uint32_t
+ */
+uint32_t WebSocketsClient::getRxAllocations(void) {
+    return _client.cRxAllocations;
+}
+
 /**
  * get client state
  * @param client WSclient_t *  ptr to the client struct
@@ -545,6 +681,8 @@ void WebSocketsClient::handleClientData(void) {
                 WebSockets::clientDisconnect(&_client, 1002);
                 break;
         }
+    } else if(_client.status == WSC_CONNECTED) {
+        WebSockets::handleWebsocketTimeout(&_client);
     }
     WEBSOCKETS_YIELD();
 }
@@ -604,7 +742,12 @@ void WebSocketsClient::sendHeader(WSclient_t * client) {
             handshake += client->cProtocol + NEW_LINE;
         }
 
-        if(client->cExtensions.length() > 0) {
+        if(_deflateWindowBits) {
+            // cExtensions gets the response of the server
+            client->cExtensions = "";
+            handshake += WEBSOCKETS_STRING("Sec-WebSocket-Extensions: ");
+            handshake += deflateOffer() + NEW_LINE;
+        } else if(client->cExtensions.length() > 0) {
             handshake += WEBSOCKETS_STRING("Sec-WebSocket-Extensions: ");
             handshake += client->cExtensions + NEW_LINE;
         }
@@ -748,6 +891,10 @@ void WebSocketsClient::handleHeader(WSclient_t * client, String * headerLine) {
             }
         }
 
+        if(ok && _deflateWindowBits && !deflateResponse(client)) {
+            ok = false;
+        }
+
         if(ok) {
             DEBUG_WEBSOCKETS("[WS-Client][handleHeader] Websocket connection init done.\n");
             headerDone(client);
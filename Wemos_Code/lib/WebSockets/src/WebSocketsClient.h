@@ -31,8 +31,10 @@ class WebSocketsClient : protected WebSockets {
   public:
 #ifdef __AVR__
     typedef void (*WebSocketClientEvent)(WStype_t type, uint8_t * payload, size_t length);
+    typedef void (*WebSocketClientStreamEvent)(WStype_t type, uint8_t * payload, size_t length, size_t offset, size_t total);
 #else
     typedef std::function<void(WStype_t type, uint8_t * payload, size_t length)> WebSocketClientEvent;
+    typedef std::function<void(WStype_t type, uint8_t * payload, size_t length, size_t offset, size_t total)> WebSocketClientStreamEvent;
 #endif
 
     WebSocketsClient(void);
@@ -70,6 +72,12 @@ class WebSocketsClient : protected WebSockets {
 #endif
 
     void onEvent(WebSocketClientEvent cbEvent);
+    void onStream(WebSocketClientStreamEvent cbStream);
+    void enableDeflate(uint8_t windowBits = WEBSOCKETS_DEFLATE_WINDOW_BITS, bool contextTakeover = true);
+    void setReassemblySize(size_t maxSize);
+    void setFragmentSize(size_t size);
+    void setWriteMode(WSwriteMode_t mode, size_t threshold = WEBSOCKETS_WRITE_COALESCE_SIZE, uint32_t timeout = WEBSOCKETS_WRITE_COALESCE_TIMEOUT);
+    bool flush(void);
 
     bool sendTXT(uint8_t * payload, size_t length = 0, bool headerToPayload = false);
     bool sendTXT(const uint8_t * payload, size_t length = 0);
@@ -81,6 +89,10 @@ class WebSocketsClient : protected WebSockets {
     bool sendBIN(uint8_t * payload, size_t length, bool headerToPayload = false);
     bool sendBIN(const uint8_t * payload, size_t length);
 
+    uint8_t * reservePayload(size_t length);
+    bool sendReservedTXT(size_t length);
+    bool sendReservedBIN(size_t length);
+
     bool sendPing(uint8_t * payload = NULL, size_t length = 0);
     bool sendPing(String & payload);
 
@@ -98,6 +110,9 @@ class WebSocketsClient : protected WebSockets {
 
     bool isConnected(void);
 
+    void setRxBuffer(uint8_t * buffer, size_t size);
+    uint32_t getRxAllocations(void);
+
   protected:
     String _host;
     uint16_t _port;
@@ -117,12 +132,15 @@ class WebSocketsClient : protected WebSockets {
     WSclient_t _client;
 
     WebSocketClientEvent _cbEvent;
+    WebSocketClientStreamEvent _cbStream;
 
     unsigned long _lastConnectionFail;
     unsigned long _reconnectInterval;
     unsigned long _lastHeaderSent;
 
     void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
+    void messageStream(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, size_t offset, size_t total, bool fin);
+    bool streamEnabled(void);
 
     void clientDisconnect(WSclient_t * client);
     bool clientIsConnected(WSclient_t * client);
@@ -43,7 +43,8 @@ WebSocketsServer::WebSocketsServer(uint16_t port, String origin, String protocol
         this);
 #endif
 
-    _cbEvent = NULL;
+    _cbEvent  = NULL;
+    _cbStream = NULL;
 
     _httpHeaderValidationFunc = NULL;
     _mandatoryHttpHeaders     = NULL;
@@ -83,6 +84,7 @@ void WebSocketsServer::begin(void) {
         client->cCode        = 0;
         client->cKey         = "";
         client->cProtocol    = "";
+        client->cExtensions  = "";
         client->cVersion     = 0;
         client->cIsUpgrade   = false;
         client->cIsWebsocket = false;
@@ -151,6 +153,40 @@ void WebSocketsServer::onEvent(WebSocketServerEvent cbEvent) {
     _cbEvent = cbEvent;
 }
 
+/**
+ * deliver data frames larger than WEBSOCKETS_STREAM_CHUNK_SIZE in chunks instead of as one event
+ * the chunks are unmasked and only valid during the callback
+ * @param cbStream WebSocketServerStreamEvent  called with client id, type, chunk, chunk length, offset in the frame and frame length
+ */
+void WebSocketsServer::onStream(WebSocketServerStreamEvent cbStream) {
+    _cbStream = cbStream;
+}
+
+/**
+ * accept permessage-deflate offers of new clients
+ * @param windowBits uint8_t     window size 2^windowBits (9 - 15), 0 disables the extension
+ * @param contextTakeover bool  keep the compression context between messages, costs 2 * 2^windowBits byte per client
+ */
+void WebSocketsServer::enableDeflate(uint8_t windowBits, bool contextTakeover) {
+    WebSockets::enableDeflate(windowBits, contextTakeover);
+}
+
+/**
+ * deliver fragmented messages as one WStype_TEXT / WStype_BIN event instead of the WStype_FRAGMENT events
+ * @param maxSize size_t  max size of a message, bigger messages close the connection with 1009, 0 disables the reassembly
+ */
+void WebSocketsServer::setReassemblySize(size_t maxSize) {
+    _reassemblySize = maxSize;
+}
+
+/**
+ * send text and binary messages bigger than size in several frames of max size byte
+ * @param size size_t  max payload per frame, 0 sends every message in one frame
+ */
+void WebSocketsServer::setFragmentSize(size_t size) {
+    _fragmentSize = size;
+}
+
 /*
  * Sets the custom http header validator function
  * @param httpHeaderValidationFunc WebSocketServerHttpHeaderValFunc ///< pointer to the custom http header validation function
@@ -277,6 +313,51 @@ bool WebSocketsServer::sendBIN(uint8_t num, const uint8_t * payload, size_t leng
     return sendBIN(num, (uint8_t *)payload, length);
 }
 
+/**
+ * get room in the transmit buffer of a client to build a payload in place, send it with sendReservedTXT or sendReservedBIN
+ * @param num uint8_t    client id
+ * @param length size_t  length of the payload
+ * @return ptr to the payload or NULL if it does not fit WEBSOCKETS_TX_BUFFER_SIZE
+ */
+uint8_t * WebSocketsServer::reservePayload(uint8_t num, size_t length) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return NULL;
+    }
+    WSclient_t * client = &_clients[num];
+    if(clientIsConnected(client)) {
+        return reserveTxBuffer(client, length);
+    }
+    return NULL;
+}
+
+/**
+ * send a payload build in the buffer of reservePayload
+ * @param num uint8_t    client id
+ * @param length size_t  length of the payload
+ * @return true if ok
+ */
+bool WebSocketsServer::sendReservedTXT(uint8_t num, size_t length) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return false;
+    }
+    WSclient_t * client = &_clients[num];
+    if(clientIsConnected(client) && client->cTxBuffer && length <= WEBSOCKETS_TX_BUFFER_SIZE) {
+        return sendFrame(client, WSop_text, client->cTxBuffer, length, true, true);
+    }
+    return false;
+}
+
+bool WebSocketsServer::sendReservedBIN(uint8_t num, size_t length) {
+    if(num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        return false;
+    }
+    WSclient_t * client = &_clients[num];
+    if(clientIsConnected(client) && client->cTxBuffer && length <= WEBSOCKETS_TX_BUFFER_SIZE) {
+        return sendFrame(client, WSop_binary, client->cTxBuffer, length, true, true);
+    }
+    return false;
+}
+
 /**
  * send binary data to client all
  * @param payload uint8_t *
@@ -548,6 +629,16 @@ void WebSocketsServer::messageReceived(WSclient_t * client, WSopcode_t opcode, u
     runCbEvent(client->num, type, payload, length);
 }
 
+void WebSocketsServer::messageStream(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, size_t offset, size_t total, bool fin) {
+    if(_cbStream) {
+        _cbStream(client->num, dataFrameType(opcode, fin), payload, length, offset, total);
+    }
+}
+
+bool WebSocketsServer::streamEnabled(void) {
+    return (_cbStream != NULL);
+}
+
 /**
  * Disconnect an client
  * @param client WSclient_t *  ptr to the client struct
@@ -583,12 +674,18 @@ void WebSocketsServer::clientDisconnect(WSclient_t * client) {
     client->cUrl         = "";
     client->cKey         = "";
     client->cProtocol    = "";
+    client->cExtensions  = "";
     client->cVersion     = 0;
     client->cIsUpgrade   = false;
     client->cIsWebsocket = false;
 
     client->cWsRXsize = 0;
 
+    releaseRxBuffer(client);
+    releaseTxBuffer(client);
+    releaseDeflate(client);
+    releaseMessageBuffer(client);
+
 #if(WEBSOCKETS_NETWORK_TYPE == NETWORK_ESP8266_ASYNC)
     client->cHttpLine = "";
 #endif
@@ -698,6 +795,8 @@ void WebSocketsServer::handleClientData(void) {
                         WebSockets::clientDisconnect(client, 1002);
                         break;
                 }
+            } else if(client->status == WSC_CONNECTED) {
+                WebSockets::handleWebsocketTimeout(client);
             }
 
             handleHBPing(client);
@@ -858,6 +957,12 @@ void WebSocketsServer::handleHeader(WSclient_t * client, String * headerLine) {
                 handshake += _protocol + NEW_LINE;
             }
 
+            String extensions;
+            if(_deflateWindowBits && deflateAccept(client, extensions)) {
+                handshake += WEBSOCKETS_STRING("Sec-WebSocket-Extensions: ");
+                handshake += extensions + NEW_LINE;
+            }
+
             // header end
             handshake += NEW_LINE;
 
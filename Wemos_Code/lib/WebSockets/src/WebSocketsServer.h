@@ -35,9 +35,11 @@ class WebSocketsServer : protected WebSockets {
   public:
 #ifdef __AVR__
     typedef void (*WebSocketServerEvent)(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
+    typedef void (*WebSocketServerStreamEvent)(uint8_t num, WStype_t type, uint8_t * payload, size_t length, size_t offset, size_t total);
     typedef bool (*WebSocketServerHttpHeaderValFunc)(String headerName, String headerValue);
 #else
     typedef std::function<void(uint8_t num, WStype_t type, uint8_t * payload, size_t length)> WebSocketServerEvent;
+    typedef std::function<void(uint8_t num, WStype_t type, uint8_t * payload, size_t length, size_t offset, size_t total)> WebSocketServerStreamEvent;
     typedef std::function<bool(String headerName, String headerValue)> WebSocketServerHttpHeaderValFunc;
 #endif
 
@@ -55,6 +57,10 @@ class WebSocketsServer : protected WebSockets {
 #endif
 
     void onEvent(WebSocketServerEvent cbEvent);
+    void onStream(WebSocketServerStreamEvent cbStream);
+    void enableDeflate(uint8_t windowBits = WEBSOCKETS_DEFLATE_WINDOW_BITS, bool contextTakeover = true);
+    void setReassemblySize(size_t maxSize);
+    void setFragmentSize(size_t size);
     void onValidateHttpHeader(
         WebSocketServerHttpHeaderValFunc validationFunc,
         const char * mandatoryHttpHeaders[],
@@ -75,6 +81,10 @@ class WebSocketsServer : protected WebSockets {
     bool sendBIN(uint8_t num, uint8_t * payload, size_t length, bool headerToPayload = false);
     bool sendBIN(uint8_t num, const uint8_t * payload, size_t length);
 
+    uint8_t * reservePayload(uint8_t num, size_t length);
+    bool sendReservedTXT(uint8_t num, size_t length);
+    bool sendReservedBIN(uint8_t num, size_t length);
+
     bool broadcastBIN(uint8_t * payload, size_t length, bool headerToPayload = false);
     bool broadcastBIN(const uint8_t * payload, size_t length);
 
@@ -114,6 +124,7 @@ class WebSocketsServer : protected WebSockets {
     WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
 
     WebSocketServerEvent _cbEvent;
+    WebSocketServerStreamEvent _cbStream;
     WebSocketServerHttpHeaderValFunc _httpHeaderValidationFunc;
 
     bool _runnning;
@@ -125,6 +136,8 @@ class WebSocketsServer : protected WebSockets {
     bool newClient(WEBSOCKETS_NETWORK_CLASS * TCPclient);
 
     void messageReceived(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, bool fin);
+    void messageStream(WSclient_t * client, WSopcode_t opcode, uint8_t * payload, size_t length, size_t offset, size_t total, bool fin);
+    bool streamEnabled(void);
 
     void clientDisconnect(WSclient_t * client);
     bool clientIsConnected(WSclient_t * client);
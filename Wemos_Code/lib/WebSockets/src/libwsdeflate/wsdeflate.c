@@ -0,0 +1,491 @@
+/*
+wsdeflate.c - small deflate (RFC 1951) compressor and decompressor for permessage-deflate (RFC 7692)
+
+The decoder follows the structure of puff.c by Mark Adler, the encoder is a single probe LZ77 with fixed huffman codes.
+*/
+
+#include <string.h>
+#include "wsdeflate.h"
+
+#define WSDEFLATE_MAX_BITS 15
+#define WSDEFLATE_MAX_LENGTH 258
+#define WSDEFLATE_NO_POSITION 0xFFFF
+
+static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// the sender removes the LEN and NLEN of the empty stored block of the sync flush
+static const uint8_t syncTail[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+/* ================ decompressor ================ */
+
+typedef struct {
+    uint16_t count[WSDEFLATE_MAX_BITS + 1];
+    uint16_t * symbol;
+} wsdeflate_tree_t;
+
+typedef struct {
+    const uint8_t * in;
+    size_t inLen;
+    size_t inPos;
+    uint32_t bitBuffer;
+    uint8_t bitCount;
+
+    uint8_t * out;
+    size_t outLen;
+    size_t outMax;
+
+    const uint8_t * dict;
+    size_t dictLen;
+
+    int32_t error;
+} wsdeflate_inflate_t;
+
+static uint32_t getBits(wsdeflate_inflate_t * s, uint8_t n) {
+    while(s->bitCount < n) {
+        uint32_t byte;
+        if(s->inPos < s->inLen) {
+            byte = s->in[s->inPos];
+        } else if(s->inPos < s->inLen + sizeof(syncTail)) {
+            byte = syncTail[s->inPos - s->inLen];
+        } else {
+            s->error = WSDEFLATE_ERROR;
+            return 0;
+        }
+        s->inPos++;
+        s->bitBuffer |= byte << s->bitCount;
+        s->bitCount += 8;
+    }
+
+    uint32_t value = s->bitBuffer & ((1UL << n) - 1);
+    s->bitBuffer >>= n;
+    s->bitCount -= n;
+    return value;
+}
+
+static void putByte(wsdeflate_inflate_t * s, uint8_t byte) {
+    if(s->outLen >= s->outMax) {
+        s->error = WSDEFLATE_OVERFLOW;
+        return;
+    }
+    s->out[s->outLen++] = byte;
+}
+
+static int buildTree(wsdeflate_tree_t * tree, const uint8_t * length, uint16_t n) {
+    uint16_t offset[WSDEFLATE_MAX_BITS + 1];
+
+    memset(tree->count, 0, sizeof(tree->count));
+    for(uint16_t symbol = 0; symbol < n; symbol++) {
+        tree->count[length[symbol]]++;
+    }
+
+    // reject over subscribed code sets
+    int32_t left = 1;
+    for(uint8_t len = 1; len <= WSDEFLATE_MAX_BITS; len++) {
+        left <<= 1;
+        left -= tree->count[len];
+        if(left < 0) {
+            return WSDEFLATE_ERROR;
+        }
+    }
+
+    offset[1] = 0;
+    for(uint8_t len = 1; len < WSDEFLATE_MAX_BITS; len++) {
+        offset[len + 1] = offset[len] + tree->count[len];
+    }
+
+    for(uint16_t symbol = 0; symbol < n; symbol++) {
+        if(length[symbol] != 0) {
+            tree->symbol[offset[length[symbol]]++] = symbol;
+        }
+    }
+    return 0;
+}
+
+static int32_t decodeSymbol(wsdeflate_inflate_t * s, const wsdeflate_tree_t * tree) {
+    int32_t code  = 0;
+    int32_t first = 0;
+    int32_t index = 0;
+
+    for(uint8_t len = 1; len <= WSDEFLATE_MAX_BITS; len++) {
+        code |= getBits(s, 1);
+        int32_t count = tree->count[len];
+        if(code - count < first) {
+            return tree->symbol[index + (code - first)];
+        }
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    s->error = WSDEFLATE_ERROR;
+    return -1;
+}
+
+static void inflateStored(wsdeflate_inflate_t * s) {
+    // skip to the next byte
+    s->bitBuffer = 0;
+    s->bitCount  = 0;
+
+    uint16_t len  = getBits(s, 16);
+    uint16_t nlen = getBits(s, 16);
+    if((uint16_t)(len ^ nlen) != 0xFFFF) {
+        s->error = WSDEFLATE_ERROR;
+        return;
+    }
+
+    while(len-- > 0 && !s->error) {
+        putByte(s, getBits(s, 8));
+    }
+}
+
+static void inflateCodes(wsdeflate_inflate_t * s, const wsdeflate_tree_t * literals, const wsdeflate_tree_t * distances) {
+    while(!s->error) {
+        int32_t symbol = decodeSymbol(s, literals);
+        if(symbol < 0) {
+            return;
+        }
+
+        if(symbol < 256) {
+            putByte(s, symbol);
+            continue;
+        }
+
+        if(symbol == 256) {
+            return;
+        }
+
+        symbol -= 257;
+        if(symbol >= 29) {
+            s->error = WSDEFLATE_ERROR;
+            return;
+        }
+        uint16_t len = lengthBase[symbol] + getBits(s, lengthExtra[symbol]);
+
+        symbol = decodeSymbol(s, distances);
+        if(symbol < 0 || symbol >= 30) {
+            s->error = WSDEFLATE_ERROR;
+            return;
+        }
+        size_t distance = distanceBase[symbol] + getBits(s, distanceExtra[symbol]);
+        if(distance > s->outLen + s->dictLen) {
+            s->error = WSDEFLATE_ERROR;
+            return;
+        }
+
+        // byte wise since source and destination may overlap
+        while(len-- > 0 && !s->error) {
+            if(distance <= s->outLen) {
+                putByte(s, s->out[s->outLen - distance]);
+            } else {
+                putByte(s, s->dict[s->dictLen - (distance - s->outLen)]);
+            }
+        }
+    }
+}
+
+static void inflateFixed(wsdeflate_inflate_t * s) {
+    uint16_t literalSymbols[288];
+    uint16_t distanceSymbols[30];
+    wsdeflate_tree_t literals  = { { 0 }, literalSymbols };
+    wsdeflate_tree_t distances = { { 0 }, distanceSymbols };
+    uint8_t length[288];
+
+    memset(&length[0], 8, 144);
+    memset(&length[144], 9, 112);
+    memset(&length[256], 7, 24);
+    memset(&length[280], 8, 8);
+    buildTree(&literals, length, 288);
+
+    memset(length, 5, 30);
+    buildTree(&distances, length, 30);
+
+    inflateCodes(s, &literals, &distances);
+}
+
+static void inflateDynamic(wsdeflate_inflate_t * s) {
+    static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    uint16_t literalSymbols[288];
+    uint16_t distanceSymbols[30];
+    wsdeflate_tree_t literals  = { { 0 }, literalSymbols };
+    wsdeflate_tree_t distances = { { 0 }, distanceSymbols };
+    uint8_t length[286 + 30];
+
+    uint16_t nlen  = getBits(s, 5) + 257;
+    uint16_t ndist = getBits(s, 5) + 1;
+    uint16_t ncode = getBits(s, 4) + 4;
+    if(s->error || nlen > 286 || ndist > 30) {
+        s->error = WSDEFLATE_ERROR;
+        return;
+    }
+
+    // code length code, the literal tree is used for it
+    memset(length, 0, 19);
+    for(uint8_t i = 0; i < ncode; i++) {
+        length[order[i]] = getBits(s, 3);
+    }
+    if(s->error || buildTree(&literals, length, 19) != 0) {
+        s->error = WSDEFLATE_ERROR;
+        return;
+    }
+
+    uint16_t index = 0;
+    while(index < nlen + ndist && !s->error) {
+        int32_t symbol = decodeSymbol(s, &literals);
+        if(symbol < 0) {
+            return;
+        }
+
+        if(symbol < 16) {
+            length[index++] = symbol;
+            continue;
+        }
+
+        uint8_t len = 0;
+        uint8_t repeat;
+        if(symbol == 16) {
+            if(index == 0) {
+                s->error = WSDEFLATE_ERROR;
+                return;
+            }
+            len    = length[index - 1];
+            repeat = 3 + getBits(s, 2);
+        } else if(symbol == 17) {
+            repeat = 3 + getBits(s, 3);
+        } else {
+            repeat = 11 + getBits(s, 7);
+        }
+
+        if(index + repeat > nlen + ndist) {
+            s->error = WSDEFLATE_ERROR;
+            return;
+        }
+        while(repeat-- > 0) {
+            length[index++] = len;
+        }
+    }
+
+    // there has to be an end of block code
+    if(s->error || length[256] == 0) {
+        s->error = WSDEFLATE_ERROR;
+        return;
+    }
+
+    if(buildTree(&literals, length, nlen) != 0 || buildTree(&distances, length + nlen, ndist) != 0) {
+        s->error = WSDEFLATE_ERROR;
+        return;
+    }
+
+    inflateCodes(s, &literals, &distances);
+}
+
+int32_t wsdeflate_inflate(const uint8_t * in, size_t inLen, uint8_t * out, size_t outMax, const uint8_t * dict, size_t dictLen) {
+    wsdeflate_inflate_t s;
+    memset(&s, 0, sizeof(s));
+    s.in      = in;
+    s.inLen   = inLen;
+    s.out     = out;
+    s.outMax  = outMax;
+    s.dict    = dict;
+    s.dictLen = dict ? dictLen : 0;
+
+    uint32_t last;
+    do {
+        last          = getBits(&s, 1);
+        uint32_t type = getBits(&s, 2);
+        if(s.error) {
+            break;
+        }
+
+        switch(type) {
+            case 0:
+                inflateStored(&s);
+                break;
+            case 1:
+                inflateFixed(&s);
+                break;
+            case 2:
+                inflateDynamic(&s);
+                break;
+            default:
+                s.error = WSDEFLATE_ERROR;
+                break;
+        }
+        // done when the final block or the added sync flush block is read
+    } while(!s.error && !last && s.inPos < s.inLen + sizeof(syncTail));
+
+    if(s.error) {
+        return s.error;
+    }
+    return s.outLen;
+}
+
+/* ================ compressor ================ */
+
+typedef struct {
+    uint8_t * out;
+    size_t outLen;
+    size_t outMax;
+    uint32_t bitBuffer;
+    uint8_t bitCount;
+    int32_t error;
+} wsdeflate_deflate_t;
+
+static void putBits(wsdeflate_deflate_t * s, uint32_t value, uint8_t n) {
+    s->bitBuffer |= value << s->bitCount;
+    s->bitCount += n;
+    while(s->bitCount >= 8) {
+        if(s->outLen >= s->outMax) {
+            s->error = WSDEFLATE_OVERFLOW;
+            return;
+        }
+        s->out[s->outLen++] = s->bitBuffer & 0xFF;
+        s->bitBuffer >>= 8;
+        s->bitCount -= 8;
+    }
+}
+
+// huffman codes are stored most significant bit first
+static void putCode(wsdeflate_deflate_t * s, uint32_t code, uint8_t n) {
+    uint32_t reversed = 0;
+    for(uint8_t i = 0; i < n; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    putBits(s, reversed, n);
+}
+
+static void putSymbol(wsdeflate_deflate_t * s, uint16_t symbol) {
+    if(symbol <= 143) {
+        putCode(s, 0x30 + symbol, 8);
+    } else if(symbol <= 255) {
+        putCode(s, 0x190 + symbol - 144, 9);
+    } else if(symbol <= 279) {
+        putCode(s, symbol - 256, 7);
+    } else {
+        putCode(s, 0xC0 + symbol - 280, 8);
+    }
+}
+
+static void putMatch(wsdeflate_deflate_t * s, uint16_t len, uint16_t distance) {
+    uint8_t i = 28;
+    while(lengthBase[i] > len) {
+        i--;
+    }
+    putSymbol(s, 257 + i);
+    putBits(s, len - lengthBase[i], lengthExtra[i]);
+
+    i = 29;
+    while(distanceBase[i] > distance) {
+        i--;
+    }
+    putCode(s, i, 5);
+    putBits(s, distance - distanceBase[i], distanceExtra[i]);
+}
+
+// the input is searched as if it follows directly after the dictionary
+typedef struct {
+    const uint8_t * dict;
+    size_t dictLen;
+    const uint8_t * in;
+} wsdeflate_source_t;
+
+static uint8_t byteAt(const wsdeflate_source_t * source, size_t position) {
+    return (position < source->dictLen) ? source->dict[position] : source->in[position - source->dictLen];
+}
+
+static uint16_t hash3(const wsdeflate_source_t * source, size_t position) {
+    uint32_t value = ((uint32_t)byteAt(source, position) << 16) | ((uint32_t)byteAt(source, position + 1) << 8) | byteAt(source, position + 2);
+    return (uint32_t)(value * 2654435761UL) >> (32 - WSDEFLATE_HASH_BITS);
+}
+
+int32_t wsdeflate_compress(const uint8_t * in, size_t inLen, uint8_t * out, size_t outMax, uint8_t windowBits, const uint8_t * dict, size_t dictLen) {
+    uint16_t head[1 << WSDEFLATE_HASH_BITS];
+    wsdeflate_deflate_t s;
+    wsdeflate_source_t source = { dict, dict ? dictLen : 0, in };
+
+    if(windowBits > 15) {
+        windowBits = 15;
+    }
+    size_t maxDistance = (size_t)1 << windowBits;
+
+    // only the part of the dictionary inside the window can be referenced
+    if(source.dictLen > maxDistance) {
+        source.dict += source.dictLen - maxDistance;
+        source.dictLen = maxDistance;
+    }
+
+    size_t end = source.dictLen + inLen;
+    if(end >= WSDEFLATE_NO_POSITION) {
+        return WSDEFLATE_OVERFLOW;
+    }
+
+    memset(&s, 0, sizeof(s));
+    s.out    = out;
+    s.outMax = outMax;
+    memset(head, 0xFF, sizeof(head));
+
+    for(size_t j = 0; j + 3 <= source.dictLen; j++) {
+        head[hash3(&source, j)] = j;
+    }
+
+    // BFINAL 0, BTYPE 01 fixed huffman
+    putBits(&s, 0, 1);
+    putBits(&s, 1, 2);
+
+    size_t i = source.dictLen;
+    while(i < end && !s.error) {
+        size_t bestLen      = 0;
+        size_t bestDistance = 0;
+
+        if(i + 3 <= end) {
+            uint16_t h         = hash3(&source, i);
+            uint16_t candidate = head[h];
+            head[h]            = i;
+
+            if(candidate != WSDEFLATE_NO_POSITION && (i - candidate) <= maxDistance) {
+                size_t maxLen = end - i;
+                if(maxLen > WSDEFLATE_MAX_LENGTH) {
+                    maxLen = WSDEFLATE_MAX_LENGTH;
+                }
+                size_t len = 0;
+                while(len < maxLen && byteAt(&source, candidate + len) == byteAt(&source, i + len)) {
+                    len++;
+                }
+                if(len >= 3) {
+                    bestLen      = len;
+                    bestDistance = i - candidate;
+                }
+            }
+        }
+
+        if(bestLen > 0) {
+            putMatch(&s, bestLen, bestDistance);
+            // keep the positions inside the match findable
+            for(size_t j = i + 1; j < i + bestLen && j + 3 <= end; j++) {
+                head[hash3(&source, j)] = j;
+            }
+            i += bestLen;
+        } else {
+            putSymbol(&s, byteAt(&source, i));
+            i++;
+        }
+    }
+
+    // end of block
+    putSymbol(&s, 256);
+
+    // sync flush: empty stored block, only the header bits are send
+    putBits(&s, 0, 3);
+    if(s.bitCount > 0) {
+        putBits(&s, 0, 8 - s.bitCount);
+    }
+
+    if(s.error) {
+        return s.error;
+    }
+    return s.outLen;
+}
@@ -0,0 +1,56 @@
+/*
+wsdeflate.h - small deflate (RFC 1951) compressor and decompressor for permessage-deflate (RFC 7692)
+
+The compressor only emits fixed huffman blocks, the decompressor handles all block types.
+For context takeover the end of the earlier messages is passed as dictionary to both.
+Both work on whole messages in caller supplied buffers and do not allocate memory.
+*/
+
+#ifndef WSDEFLATE_H
+#define WSDEFLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// size of the match finder hash table of the compressor (2^bits entries of 2 byte on the stack)
+#ifndef WSDEFLATE_HASH_BITS
+#define WSDEFLATE_HASH_BITS 8
+#endif
+
+#define WSDEFLATE_ERROR (-1)       ///< invalid compressed data
+#define WSDEFLATE_OVERFLOW (-2)    ///< output buffer to small
+
+/**
+ * compress a message, ends with a sync flush of which the 00 00 ff ff tail is left out (RFC 7692 7.2.1)
+ * @param in         message, together with the used part of dict max 65534 byte
+ * @param inLen      length of the message
+ * @param out        buffer for the compressed message
+ * @param outMax     size of out
+ * @param windowBits max match distance is 2^windowBits (8 - 15)
+ * @param dict       end of the earlier messages for context takeover, NULL without
+ * @param dictLen    length of dict
+ * @return length of the compressed message or WSDEFLATE_OVERFLOW
+ */
+int32_t wsdeflate_compress(const uint8_t * in, size_t inLen, uint8_t * out, size_t outMax, uint8_t windowBits, const uint8_t * dict, size_t dictLen);
+
+/**
+ * decompress a message, the 00 00 ff ff tail removed by the sender is added internally
+ * @param in      compressed message
+ * @param inLen   length of the compressed message
+ * @param out     buffer for the message
+ * @param outMax  size of out
+ * @param dict    end of the earlier messages for context takeover, NULL without
+ * @param dictLen length of dict
+ * @return length of the message, WSDEFLATE_ERROR or WSDEFLATE_OVERFLOW
+ */
+int32_t wsdeflate_inflate(const uint8_t * in, size_t inLen, uint8_t * out, size_t outMax, const uint8_t * dict, size_t dictLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WSDEFLATE_H */
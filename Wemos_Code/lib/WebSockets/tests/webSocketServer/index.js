@@ -21,6 +21,65 @@ wsServer = new WebSocketServer({
     autoAcceptConnections: false
 });
  
+// Wemos firmware batching, see Wemos_Code/src/CommandTypes.hpp and DefaultFunctions.hpp
+var EVENT_BATCH = 23;
+var BINARY_FRAME_MAGIC = 0xB7;
+var BINARY_VALUE_BOOL = 0;
+var BINARY_VALUE_INT = 1;
+var BINARY_VALUE_STRING = 2;
+
+var frameCount = 0;
+var eventCount = 0;
+
+setInterval(function() {
+    if (frameCount > 0) {
+        console.log('Frames/sec: ' + frameCount + ' Events/sec: ' + eventCount);
+    }
+    frameCount = 0;
+    eventCount = 0;
+}, 1000);
+
+// returns the [command, value] pairs in a JSON message, a batch holds them in its value
+function unpackJson(data) {
+    var message;
+    try {
+        message = JSON.parse(data);
+    } catch (e) {
+        return [];
+    }
+    if (message.command === EVENT_BATCH && Array.isArray(message.value)) {
+        return message.value;
+    }
+    return [[message.command, message.value]];
+}
+
+// returns the [command, value] pairs in a binary frame: magic, version, count, then [command][type][value] records
+function unpackBinary(data) {
+    var events = [];
+    if (data.length < 3 || data[0] !== BINARY_FRAME_MAGIC) {
+        return events;
+    }
+    var offset = 3;
+    for (var i = 0; i < data[2] && offset + 2 < data.length; i++) {
+        var command = data[offset];
+        var type = data[offset + 1];
+        offset += 2;
+        if (type === BINARY_VALUE_BOOL) {
+            events.push([command, data[offset] !== 0]);
+            offset += 1;
+        } else if (type === BINARY_VALUE_INT) {
+            events.push([command, data.readInt32LE(offset)]);
+            offset += 4;
+        } else if (type === BINARY_VALUE_STRING) {
+            events.push([command, data.toString('utf8', offset + 1, offset + 1 + data[offset])]);
+            offset += 1 + data[offset];
+        } else {
+            break;
+        }
+    }
+    return events;
+}
+
 function originIsAllowed(origin) {
   // put logic here to detect whether the specified origin is allowed. 
   return true;
@@ -39,14 +98,22 @@ wsServer.on('request', function(request) {
     console.log((new Date()) + ' Connection accepted.');
     
 	connection.on('message', function(message) {
+        var events = [];
         if (message.type === 'utf8') {
             console.log('Received Message: ' + message.utf8Data);
+            events = unpackJson(message.utf8Data);
            // connection.sendUTF(message.utf8Data);
         }
         else if (message.type === 'binary') {
             console.log('Received Binary Message of ' + message.binaryData.length + ' bytes');
+            events = unpackBinary(message.binaryData);
            //connection.sendBytes(message.binaryData);
         }
+        if (events.length > 1) {
+            console.log('Unpacked batch: ' + JSON.stringify(events));
+        }
+        frameCount++;
+        eventCount += events.length;
     });
     
 	connection.on('close', function(reasonCode, description) {
@@ -2,6 +2,10 @@
 
 const char DEVICE_TYPE[] = "Chair";
 
+#define ANALOG_SAMPLE_COUNT 10
+#define ANALOG_STABILITY_MARGIN 20
+#define ANALOG_MAX_SAMPLE_INTERVAL 40
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -14,82 +18,24 @@ bool ledOn = false;
 bool vibratorOn = false;
 uint16_t pressureValue = 0;
 
-// Forward Declaration
+Filter<Median<3>, Ema<2>, Hysteresis<20>, Scale<1023, 255>> pressureFilter;
 
-void handleMessage(JsonObject message);
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(CHAIR_BUTTON_PRESSED, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 0, &buttonPressed),
+    DEVICE_CHANNEL(CHAIR_LED_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 0, &ledOn),
+    DEVICE_CHANNEL(CHAIR_VIBRATOR_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 1, &vibratorOn),
+    DEVICE_FILTERED_CHANNEL(CHAIR_PRESSURE_SENSOR_VALUE, CHANNEL_UINT16, BINDING_ANALOG_INPUT, 0, &pressureValue, SENSOR_FILTER(pressureFilter))};
 
 // Setup
 
 void setup()
 {
-    initSerial();
-
-    initI2C();
-
-    generateUUID();
-
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 }
 
 // Loop
 
 void loop()
 {
-    updateDigitalI2CInputs(&buttonPressed, CHAIR_BUTTON_PRESSED);
-
-    updateAnalogI2CInputs(10, 20, 255, &pressureValue, CHAIR_PRESSURE_SENSOR_VALUE);
-
-    updateDigitalI2COutputs(&ledOn, &vibratorOn);
-
-    sendHeartbeat();
-
-    webSocket.loop();
-}
-
-// Function definitions
-
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["CHAIR_LED_ON"] = ledOn;
-        deviceInfoMessage["CHAIR_VIBRATOR_ON"] = vibratorOn;
-        deviceInfoMessage["CHAIR_PRESSURE_SENSOR_VALUE"] = pressureValue;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case CHAIR_LED_ON:
-    {
-        ledOn = (bool)message["value"];
-        break;
-    }
-
-    case CHAIR_VIBRATOR_ON:
-    {
-        vibratorOn = (bool)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
+    runScheduler();
 }
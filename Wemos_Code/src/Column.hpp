@@ -2,6 +2,10 @@
 
 const char DEVICE_TYPE[] = "Column";
 
+#define ANALOG_SAMPLE_COUNT 10
+#define ANALOG_STABILITY_MARGIN 5
+#define ANALOG_MAX_SAMPLE_INTERVAL 160
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -14,82 +18,24 @@ bool buzzerOn = false;
 bool ledOn = false;
 uint16_t smokeValue = 0;
 
-// Forward Declaration
+Filter<Median<5>, Ema<3>, Hysteresis<5>, Scale<1023, 255>> smokeFilter;
 
-void handleMessage(JsonObject message);
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(COLUMN_BUTTON_PRESSED, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 0, &buttonPressed),
+    DEVICE_CHANNEL(COLUMN_LED_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 1, &ledOn),
+    DEVICE_CHANNEL(COLUMN_BUZZER_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 0, &buzzerOn),
+    DEVICE_FILTERED_CHANNEL(COLUMN_SMOKE_SENSOR_VALUE, CHANNEL_UINT16, BINDING_ANALOG_INPUT, 0, &smokeValue, SENSOR_FILTER(smokeFilter))};
 
 // Setup
 
 void setup()
 {
-    initSerial();
-
-    initI2C();
-
-    generateUUID();
-
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 }
 
 // Loop
 
 void loop()
 {
-    updateDigitalI2CInputs(&buttonPressed, COLUMN_BUTTON_PRESSED);
-
-    updateAnalogI2CInputs(10, 5, 255, &smokeValue, COLUMN_SMOKE_SENSOR_VALUE);
-
-    updateDigitalI2COutputs(&buzzerOn, &ledOn);
-
-    sendHeartbeat();
-
-    webSocket.loop();
+    runScheduler();
 }
-
-// Function definitions
-
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["COLUMN_LED_ON"] = ledOn;
-        deviceInfoMessage["COLUMN_BUZZER_ON"] = buzzerOn;
-        deviceInfoMessage["COLUMN_SMOKE_SENSOR_VALUE"] = smokeValue;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case COLUMN_LED_ON:
-    {
-        ledOn = (bool)message["value"];
-        break;
-    }
-
-    case COLUMN_BUZZER_ON:
-    {
-        buzzerOn = (bool)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
-}
\ No newline at end of file
@@ -11,7 +11,23 @@ enum GeneralDeviceCommands
 {
     HEARTBEAT = 20,
     REGISTRATION = 21,
-    DEVICE_INFO = 22
+    DEVICE_INFO = 22,
+    EVENT_BATCH = 23,
+    REPORTING_CONFIGURATION = 24
+};
+
+enum MessageProtocols
+{
+    PROTOCOL_JSON = 0,
+    PROTOCOL_BINARY = 1,
+    PROTOCOL_JSON_BATCH = 2 // JSON, queued events may be sent together as an EVENT_BATCH
+};
+
+enum BinaryValueTypes
+{
+    BINARY_VALUE_BOOL = 0,
+    BINARY_VALUE_INT = 1,
+    BINARY_VALUE_STRING = 2
 };
 
 enum DeviceStatus
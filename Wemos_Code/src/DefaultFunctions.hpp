@@ -5,15 +5,119 @@
 
 #define DIRECT_OUTPUT_PIN 14 //D5
 
+#define I2C_DIGITAL_ADDRESS 0x38 // PCA9554
+#define I2C_ANALOG_ADDRESS 0x36  // MAX11647
+
+// Define PCA9554_INT_PIN in the device file when the INT output of the digital I2C board is connected,
+// the input port is then only read when it signals a change
+
+// Time in ms between two checks if the I2C chips still hold their configuration
+#ifndef I2C_VERIFY_INTERVAL
+#define I2C_VERIFY_INTERVAL 5000
+#endif
+
 #define HEARTBEAT_INTERVAL 500
 
+// Period in ms of the shared tasks, the network task runs every pass of the scheduler
+#ifndef CHANNEL_POLL_INTERVAL
+#define CHANNEL_POLL_INTERVAL 5
+#endif
+
+// Time in us a shared task may take before the scheduler counts it as an overrun
+#define NETWORK_TASK_BUDGET 2000
+#define CHANNEL_TASK_BUDGET 1500
+#define HEARTBEAT_TASK_BUDGET 1000
+
+// Binary frame layout: magic, version, record count, followed by records of [command][value type][value]
+#define BINARY_FRAME_MAGIC 0xB7
+#define BINARY_FRAME_VERSION 1
+#define BINARY_FRAME_HEADER_SIZE 3
+#define BINARY_FRAME_SIZE 64
+
+// Maximum amount of different commands that can be collected into one batch
+#define EVENT_QUEUE_SIZE 8
+
+// Time in ms events are collected before they are send, 0 sends them at the end of every loop
+#ifndef EVENT_QUEUE_WINDOW
+#define EVENT_QUEUE_WINDOW 0
+#endif
+
+// Size of the pre-rendered {"UUID":..,"Type":..,"command": prefix plus the command/value tail
+#define MESSAGE_TEMPLATE_SIZE (96 + EVENT_QUEUE_SIZE * 20)
+
+// Size of the DEVICE_INFO message generated from the device channels
+#define DEVICE_INFO_SIZE 512
+
+// Write mode of the websocket, WSwrite_throughput collects the frames for WEBSOCKETS_WRITE_COALESCE_TIMEOUT ms
+// and writes them as one TCP segment. Interactive devices define WSwrite_lowLatency before including this file.
+#ifndef WEBSOCKET_WRITE_MODE
+#define WEBSOCKET_WRITE_MODE WSwrite_throughput
+#endif
+
+// Maximum size of a fragmented message from the hub, it is reassembled and handled like a single frame
+#define WEBSOCKET_MESSAGE_MAX_SIZE 1024
+
+// Every device uses its own range of ten commands, see CommandTypes.hpp
+#define DEVICE_COMMAND_RANGE 10
+
+// Maximum amount of numbers that are decoded from an array value, REPORTING_CONFIGURATION uses four
+#define DEVICE_MESSAGE_MAX_VALUES 4
+
+// The reporting configuration is stored in EEPROM behind the UUID
+#define REPORTING_EEPROM_ADDRESS 16
+#define REPORTING_MAX_ENTRIES (PCA9554_CHANNELS + MAX11647_CHANNELS)
+
+// Analog input settings, can be overridden by the device before including this file
+#ifndef ANALOG_SAMPLE_COUNT
+#define ANALOG_SAMPLE_COUNT 10
+#endif
+
+// Minimal time in ms between two analog samples, one sample is taken per loop so the loop is never blocked
+#ifndef ANALOG_SAMPLE_INTERVAL
+#define ANALOG_SAMPLE_INTERVAL 5
+#endif
+
+// Maximal time in ms between two analog samples, the interval doubles up to this value while the input is stable
+#ifndef ANALOG_MAX_SAMPLE_INTERVAL
+#define ANALOG_MAX_SAMPLE_INTERVAL 320
+#endif
+
+// Amount of conversions that are read back-to-back in one I2C request, at most 8 when both channels are used
+#ifndef ANALOG_SAMPLES_PER_READ
+#define ANALOG_SAMPLES_PER_READ 1
+#endif
+
+#ifndef ANALOG_STABILITY_MARGIN
+#define ANALOG_STABILITY_MARGIN 20
+#endif
+
+#ifndef ANALOG_OUTPUT_SCALE
+#define ANALOG_OUTPUT_SCALE 255
+#endif
+
 #ifndef NUMBER_OF_LEDS
 #define NUMBER_OF_LEDS 1
 #endif
 
+// Describes one entry of a device channel table, the name is the command as text
+#define DEVICE_CHANNEL(command, type, binding, io, value) \
+    {                                                     \
+        command, #command, type, binding, io, value, nullptr \
+    }
+
+// Describes an input channel whose raw value is passed through a filter chain, see SensorFilter.hpp
+#define DEVICE_FILTERED_CHANNEL(command, type, binding, io, value, filter) \
+    {                                                                      \
+        command, #command, type, binding, io, value, filter                \
+    }
+
 // Includes
 
 #include "CommandTypes.hpp"
+#include "TaskScheduler.hpp"
+#include "PCA9554.hpp"
+#include "MAX11647.hpp"
+#include "SensorFilter.hpp"
 
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
@@ -26,13 +130,119 @@
 #include <Servo.h>
 #include <FastLED.h>
 
+// Types
+
+struct DeviceMessage
+{
+    int command;
+    int value;               // true and false are decoded as 1 and 0
+    const char *stringValue; // Points into the received payload when the value is a string, otherwise nullptr
+    int values[DEVICE_MESSAGE_MAX_VALUES]; // Numbers of the value when it is an array
+    uint8_t valueCount;
+};
+
+enum ChannelType
+{
+    CHANNEL_BOOL,
+    CHANNEL_UINT8,
+    CHANNEL_UINT16
+};
+
+enum ChannelBinding
+{
+    BINDING_DIGITAL_INPUT,  // Input of the digital I2C board, io is the input number
+    BINDING_ANALOG_INPUT,   // Input of the analog I2C board, io is the input number
+    BINDING_DIGITAL_OUTPUT, // Output of the digital I2C board, io is the output number, set by the hub
+    BINDING_SETPOINT,       // Set by the hub and applied by the device itself
+    BINDING_STATE           // Only reported in DEVICE_INFO
+};
+
+struct DeviceChannel
+{
+    int command;
+    const char *name;
+    ChannelType type;
+    ChannelBinding binding;
+    uint8_t io;
+    void *value;
+    bool (*filter)(uint16_t &value); // Replaces the threshold and scaling of an input when set
+};
+
+// Runtime state of an input channel of one of the I2C boards
+struct InputChannel
+{
+    int command;
+    ChannelType type;
+    uint8_t io;
+    void *value;
+    uint16_t previous;  // Last raw value that was stored in value, or the last filtered value when there is a filter
+    uint16_t threshold; // Amount the raw value has to change before a new update is send
+    uint16_t scale;     // Max value the raw 10 bit value is rescaled to, 0 keeps the raw value
+    uint32_t sum;       // Sum of the samples of the current analog window
+    uint16_t average;   // Average of the last analog window
+    uint16_t sampleInterval;
+    uint16_t minSampleInterval;
+    uint16_t maxSampleInterval;
+    bool (*filter)(uint16_t &value);
+    uint16_t latest;            // Last value that was stored in value
+    uint16_t reported;          // Last value that was send to the hub
+    uint16_t reportableChange;  // Amount the value has to change before it is reported, 0 reports every change
+    uint32_t minReportInterval; // Minimal time in ms between two reports, changes in between are reported afterwards
+    uint32_t maxReportInterval; // Time in ms after which the value is reported even if it did not change, 0 disables it
+    uint32_t lastReport;
+    bool reportPending;
+    bool initialized;
+};
+
+// Reporting configuration of one input channel as it is stored in EEPROM
+struct ReportingEntry
+{
+    uint8_t command;
+    uint16_t reportableChange;
+    uint32_t minReportInterval;
+    uint32_t maxReportInterval;
+};
+
+struct QueuedEvent
+{
+    uint8_t command;
+    uint8_t valueType;
+    int32_t value;
+};
+
 // Global variables
 
 WebSocketsClient webSocket;
 bool websocketConnected = false;
 char UUID[11];
 const char *deviceType;
-void (*handleWebsocketMessage)(JsonObject);
+uint8_t messageProtocol = PROTOCOL_JSON;
+char messageTemplate[WEBSOCKETS_MAX_HEADER_SIZE + MESSAGE_TEMPLATE_SIZE];
+size_t messageTemplateLength = 0;
+QueuedEvent eventQueue[EVENT_QUEUE_SIZE];
+uint8_t eventQueueCount = 0;
+uint32_t eventQueueStart = 0;
+void (*handleWebsocketMessage)(const DeviceMessage &);
+
+const DeviceChannel *deviceChannels = nullptr;
+uint8_t deviceChannelCount = 0;
+int deviceCommandBase = 0;
+int8_t deviceChannelIndex[DEVICE_COMMAND_RANGE];
+InputChannel digitalInputChannels[PCA9554_CHANNELS];
+InputChannel analogInputChannels[MAX11647_CHANNELS];
+bool *digitalOutputChannels[PCA9554_CHANNELS];
+uint8_t digitalInputMask = 0; // Bit per input or output that is used by the device
+uint8_t analogInputMask = 0;
+uint8_t digitalOutputMask = 0;
+uint8_t analogSamplesTaken = 0;
+uint32_t lastAnalogSample = 0;
+uint16_t analogSampleInterval = ANALOG_SAMPLE_INTERVAL;
+
+PCA9554 digitalI2C(I2C_DIGITAL_ADDRESS);
+MAX11647 analogI2C(I2C_ANALOG_ADDRESS);
+uint32_t lastDigitalI2CVerify = 0;
+uint32_t lastAnalogI2CVerify = 0;
+uint32_t lastI2CStatistics = 0;
 
 CRGB fastRGB_LEDs[NUMBER_OF_LEDS];
 
@@ -42,25 +252,58 @@ void initSerial();
 void initI2C();
 void initFastLED();
 void initWifi();
-void initWebsocket(void (*messageHandler)(JsonObject), const char *deviceType);
+void initWebsocket(void (*messageHandler)(const DeviceMessage &), const char *deviceType);
+
+template <size_t channelCount>
+void initDevice(const char *deviceType, const DeviceChannel (&channels)[channelCount]);
+void handleDeviceMessage(const DeviceMessage &message);
+void sendDeviceInfo();
+void updateDeviceChannels();
+void pumpNetwork();
+int readChannelValue(const DeviceChannel &channel);
+bool writeChannelValue(const DeviceChannel &channel, int value);
 
 void websocketEvent(WStype_t type, uint8_t *payload, size_t length);
 
+bool decodeMessage(char *payload, DeviceMessage *message);
+char *decodeJsonValue(char *position, int *number, const char **string);
+char *decodeJsonArray(char *position, int *values, uint8_t *valueCount);
+char *decodeJsonString(char *position, bool terminate);
+char *skipWhitespace(char *position);
+
 void sendIntMessage(int command, int value);
 void sendBoolMessage(int command, bool value);
 void sendStringMessage(int command, char *value);
+void sendBinaryMessage(int command, uint8_t valueType, const uint8_t *value, uint8_t valueLength);
+void renderMessageTemplate();
+void sendTemplateMessage(int command, const char *value);
+
+void queueEvent(int command, uint8_t valueType, int32_t value);
+void flushEventQueue(bool force = false);
+void sendBinaryEvents();
+void sendJsonEvents();
+void formatEventValue(const QueuedEvent &event, char *valueText);
 
 void sendHeartbeat();
 
 void generateUUID();
 
-void checkConnectionI2C();
-
-void readDigitalI2CInputs(bool *input0State, bool *input1State = nullptr);
-void updateDigitalI2CInputs(bool *input0State, int input0Command, bool *input1State = nullptr, int input1Command = 0);
-void readAnalogI2CInputs(int sampleCount, uint16_t *input0Value, uint16_t *input1Value = nullptr);
-void updateAnalogI2CInputs(int sampleCount, int stabilityMargin, uint16_t outputScale, uint16_t *input0Value, int input0Command, uint16_t *input1Value = nullptr, int input1Command = 0);
-void updateDigitalI2COutputs(bool *output0State, bool *output1State = nullptr);
+bool ensureDigitalI2C();
+bool ensureAnalogI2C();
+void printI2CStatistics();
+
+InputChannel makeInputChannel(const DeviceChannel &channel, uint16_t threshold, uint16_t scale, uint16_t minSampleInterval = 0, uint16_t maxSampleInterval = 0);
+void adaptSampleInterval(InputChannel &input, uint16_t sample, bool windowComplete);
+void publishInputChannel(InputChannel &input, uint16_t raw);
+void updateReporting();
+void reportInputChannel(InputChannel &input);
+InputChannel *findInputChannel(int command);
+void configureReporting(const DeviceMessage &message);
+void loadReportingConfiguration();
+void saveReportingConfiguration();
+void updateDigitalInputChannels();
+void updateAnalogInputChannels();
+void updateDigitalOutputChannels();
 
 void setServoAngle(int angle);
 
@@ -78,12 +321,25 @@ void initSerial()
 }
 
 /*!
-    @brief Starts the I2C connection
+    @brief Starts the I2C connection and configures the chips the channel table uses, a chip that is not used is never accessed
 */
 void initI2C()
 {
     Wire.begin();
-    checkConnectionI2C();
+
+    if (digitalInputMask | digitalOutputMask)
+    {
+#ifdef PCA9554_INT_PIN
+        digitalI2C.attachInterruptPin(PCA9554_INT_PIN);
+#endif
+
+        ensureDigitalI2C();
+    }
+
+    if (analogInputMask)
+    {
+        ensureAnalogI2C();
+    }
 }
 
 /*!
@@ -111,12 +367,22 @@ void initWifi()
 /*!
     @brief Starts the Websocket Client and connects with the server.
 */
-void initWebsocket(void (*messageHandler)(JsonObject), const char *p_deviceType)
+void initWebsocket(void (*messageHandler)(const DeviceMessage &), const char *p_deviceType)
 {
     handleWebsocketMessage = messageHandler;
 
     deviceType = p_deviceType;
 
+    renderMessageTemplate();
+
+    // compress the repetitive JSON messages, with a window of 512 byte per direction
+    webSocket.enableDeflate(9);
+
+    // fragmented messages arrive as one WStype_TEXT event
+    webSocket.setReassemblySize(WEBSOCKET_MESSAGE_MAX_SIZE);
+
+    webSocket.setWriteMode(WEBSOCKET_WRITE_MODE);
+
     // server address, port and URL
     webSocket.begin("10.0.1.1", 9002, "/");
 
@@ -128,446 +394,1443 @@ void initWebsocket(void (*messageHandler)(JsonObject), const char *p_deviceType)
 }
 
 /*!
-    @brief Interrupt that is called when a new message is received by the websocket client
-    @param[in] type Event type that is invoked, ex. CONNECTED, DISCONNECTED or new TEXT
-    @param[in] payload A pointer to the payload of the message, in this case a JSON message
-    @param[in] length Length of the message that the pointer is pointing to.
+    @brief Starts everything a device needs and builds the dispatch and polling tables from its channel table
+    @param[in] p_deviceType The type of the device, send with every message
+    @param[in] channels The channel table of the device, see DEVICE_CHANNEL
 */
-void websocketEvent(WStype_t type, uint8_t *payload, size_t length)
+template <size_t channelCount>
+void initDevice(const char *p_deviceType, const DeviceChannel (&channels)[channelCount])
 {
-    switch (type)
+    static_assert(channelCount <= DEVICE_COMMAND_RANGE, "A device can not have more channels than commands");
+
+    bool usesI2C = false;
+
+    deviceChannels = channels;
+    deviceChannelCount = channelCount;
+    deviceCommandBase = channels[0].command - (channels[0].command % DEVICE_COMMAND_RANGE);
+    memset(deviceChannelIndex, -1, sizeof(deviceChannelIndex));
+    memset(digitalInputChannels, 0, sizeof(digitalInputChannels));
+    memset(analogInputChannels, 0, sizeof(analogInputChannels));
+    memset(digitalOutputChannels, 0, sizeof(digitalOutputChannels));
+
+    initSerial();
+
+    for (uint8_t i = 0; i < channelCount; i++)
     {
-    case WStype_DISCONNECTED:
-        if (websocketConnected)
+        const DeviceChannel &channel = channels[i];
+        int offset = channel.command - deviceCommandBase;
+
+        if (offset < 0 || offset >= DEVICE_COMMAND_RANGE)
         {
-            Serial.printf("[Websocket] Disconnected!\n");
-            websocketConnected = false;
+            Serial.printf("[ERROR] Command %d is outside the command range of the device\n", channel.command);
+            continue;
         }
-        break;
-    case WStype_CONNECTED:
-    {
-        Serial.printf("[Websocket] Connected!\n");
-
-        StaticJsonDocument<200> message;
-        char stringMessage[200];
+        deviceChannelIndex[offset] = i;
 
-        message["UUID"] = UUID;
-        message["Type"] = deviceType;
-        message["command"] = REGISTRATION;
-        message["value"] = "";
+        switch (channel.binding)
+        {
+        case BINDING_DIGITAL_INPUT:
+            if (channel.io >= PCA9554_CHANNELS)
+            {
+                Serial.printf("[ERROR] Digital input %d of command %d does not exist\n", channel.io, channel.command);
+                break;
+            }
+            digitalInputChannels[channel.io] = makeInputChannel(channel, 0, 0);
+            digitalInputMask |= 1 << channel.io;
+            usesI2C = true;
+            break;
 
-        serializeJson(message, stringMessage);
+        case BINDING_ANALOG_INPUT:
+            if (channel.io >= MAX11647_CHANNELS)
+            {
+                Serial.printf("[ERROR] Analog input %d of command %d does not exist\n", channel.io, channel.command);
+                break;
+            }
+            analogInputChannels[channel.io] = makeInputChannel(channel, ANALOG_STABILITY_MARGIN, ANALOG_OUTPUT_SCALE, ANALOG_SAMPLE_INTERVAL, ANALOG_MAX_SAMPLE_INTERVAL);
+            analogInputMask |= 1 << channel.io;
+            usesI2C = true;
+            break;
 
-        Serial.printf("[Websocket] Sending registration: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
+        case BINDING_DIGITAL_OUTPUT:
+            if (channel.io >= PCA9554_CHANNELS)
+            {
+                Serial.printf("[ERROR] Digital output %d of command %d does not exist\n", channel.io, channel.command);
+                break;
+            }
+            digitalOutputChannels[channel.io] = (bool *)channel.value;
+            digitalOutputMask |= 1 << channel.io;
+            usesI2C = true;
+            break;
 
-        websocketConnected = true;
-        break;
+        default:
+            break;
+        }
     }
-    case WStype_TEXT:
-    {
-        Serial.printf("[Websocket] New message: %s\n", payload);
 
-        DynamicJsonDocument doc(1024);
-        deserializeJson(doc, payload);
-        JsonObject obj = doc.as<JsonObject>();
-
-        handleWebsocketMessage(obj);
-        break;
-    }
-    default:
-        break;
+    if (usesI2C)
+    {
+        initI2C();
     }
-}
 
-/*!
-    @brief Sends a new message over the Websocket connection with an integer as JSON value
-    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
-    @param[in] value An integer value that is send with the command as parameter.
-*/
-void sendIntMessage(int command, int value)
-{
-    StaticJsonDocument<200> message;
-    char stringMessage[200];
+    generateUUID();
 
-    message["UUID"] = UUID;
-    message["Type"] = deviceType;
-    message["command"] = command;
-    message["value"] = value;
+    loadReportingConfiguration();
 
-    serializeJson(message, stringMessage);
+    initWifi();
 
-    Serial.printf("Sending message: %s\n", stringMessage);
-    webSocket.sendTXT(stringMessage);
+    initWebsocket(&handleDeviceMessage, p_deviceType);
+
+    addTask("network", &pumpNetwork, 0, NETWORK_TASK_BUDGET, TASK_HIGH_PRIORITY);
+    addTask("heartbeat", &sendHeartbeat, HEARTBEAT_INTERVAL, HEARTBEAT_TASK_BUDGET);
+    if (usesI2C)
+    {
+        addTask("channels", &updateDeviceChannels, CHANNEL_POLL_INTERVAL, CHANNEL_TASK_BUDGET);
+    }
 }
 
 /*!
-    @brief Sends a new message over the Websocket connection with an bool as JSON value
-    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
-    @param[in] value A boolean value that is send with the command as parameter.
+    @brief Reads the incoming message and updates the channel it is meant for or sends the device information back.
 */
-void sendBoolMessage(int command, bool value)
+void handleDeviceMessage(const DeviceMessage &message)
 {
-    StaticJsonDocument<200> message;
-    char stringMessage[200];
-
-    message["UUID"] = UUID;
-    message["Type"] = deviceType;
-    message["command"] = command;
-    message["value"] = value;
+    if (message.command == DEVICE_INFO)
+    {
+        sendDeviceInfo();
+        return;
+    }
 
-    serializeJson(message, stringMessage);
+    if (message.command == REPORTING_CONFIGURATION)
+    {
+        configureReporting(message);
+        return;
+    }
 
-    Serial.printf("Sending message: %s\n", stringMessage);
-    webSocket.sendTXT(stringMessage);
-}
+    int offset = message.command - deviceCommandBase;
 
-/*!
-    @brief Sends a new message over the Websocket connection with an string as JSON value
-    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
-    @param[in] value A string value that is send with the command as parameter.
-*/
-void sendStringMessage(int command, char *value)
-{
-    StaticJsonDocument<200> message;
-    char stringMessage[200];
+    if (offset < 0 || offset >= DEVICE_COMMAND_RANGE || deviceChannelIndex[offset] < 0)
+    {
+        Serial.printf("[Error] Unsupported command received: %d\n", message.command);
+        return;
+    }
 
-    message["UUID"] = UUID;
-    message["Type"] = deviceType;
-    message["command"] = command;
-    message["value"] = value;
+    const DeviceChannel &channel = deviceChannels[deviceChannelIndex[offset]];
 
-    serializeJson(message, stringMessage);
+    if (channel.binding != BINDING_DIGITAL_OUTPUT && channel.binding != BINDING_SETPOINT)
+    {
+        Serial.printf("[Error] Command %d can not be set\n", message.command);
+        return;
+    }
 
-    Serial.printf("Sending message: %s\n", stringMessage);
-    webSocket.sendTXT(stringMessage);
+    if (!writeChannelValue(channel, message.value))
+    {
+        Serial.printf("[Error] Value %d out of range for command %d\n", message.value, message.command);
+    }
 }
 
 /*!
-    @brief Check if the heartbeat interval time has passed and then send a heartbeat
+    @brief Sends the value of every channel of the device, the channel names are used as keys
 */
-void sendHeartbeat()
+void sendDeviceInfo()
 {
-    static uint32_t lastTime = 0;
+    char deviceInfo[WEBSOCKETS_MAX_HEADER_SIZE + DEVICE_INFO_SIZE];
+    char *payload = &deviceInfo[WEBSOCKETS_MAX_HEADER_SIZE];
+    char *tail = &payload[messageTemplateLength];
 
-    if ((millis() - lastTime) > HEARTBEAT_INTERVAL)
+    memcpy(payload, &messageTemplate[WEBSOCKETS_MAX_HEADER_SIZE], messageTemplateLength);
+    itoa(DEVICE_INFO, tail, 10);
+    tail += strlen(tail);
+
+    for (uint8_t i = 0; i < deviceChannelCount; i++)
     {
-        lastTime = millis();
-        if (websocketConnected)
-        {
-            StaticJsonDocument<200> message;
-            char stringMessage[200];
+        const DeviceChannel &channel = deviceChannels[i];
 
-            message["UUID"] = UUID;
-            message["Type"] = deviceType;
-            message["command"] = HEARTBEAT;
+        // Room for the quotes, colon, comma, value and closing brace
+        if ((size_t)(tail - payload) + strlen(channel.name) + 16 > DEVICE_INFO_SIZE)
+        {
+            Serial.printf("[ERROR] DEVICE_INFO does not fit, %s left out\n", channel.name);
+            break;
+        }
 
-            serializeJson(message, stringMessage);
+        *tail++ = ',';
+        *tail++ = '"';
+        strcpy(tail, channel.name);
+        tail += strlen(tail);
+        *tail++ = '"';
+        *tail++ = ':';
 
-            webSocket.sendTXT(stringMessage);
+        if (channel.type == CHANNEL_BOOL)
+        {
+            strcpy(tail, readChannelValue(channel) ? "true" : "false");
         }
+        else
+        {
+            itoa(readChannelValue(channel), tail, 10);
+        }
+        tail += strlen(tail);
     }
+
+    *tail++ = '}';
+    *tail = '\0';
+
+    Serial.printf("Sending DEVICE_INFO: %s\n", payload);
+    webSocket.sendTXT(deviceInfo, tail - payload, true);
 }
 
 /*!
-    @brief Read the UUID from EEPROM or generates a new one if none is present
+    @brief Reads the inputs and updates the outputs of the I2C boards for all channels in the device table
 */
-void generateUUID()
+void updateDeviceChannels()
 {
-    uint addr = 0;
-
-    struct
-    {
-        uint8_t code[3];
-        char uuid[11] = "";
-    } data;
-
-    EEPROM.begin(512);
-    EEPROM.get(addr, data);
-
-    if (data.code[0] == 34 && data.code[1] == 42 && data.code[2] == 16)
-    {
-        strcpy(UUID, data.uuid);
-        Serial.printf("[SETUP] UUID loaded! ID is: %s\n", UUID);
-        return;
-    }
-    else
-    {
-        randomSeed(ESP.getCycleCount());
+    updateDigitalOutputChannels();
 
-        char buffer[1];
-        for (int i = 0; i < 10; i++)
-        {
-            itoa(random(9), buffer, 10);
-            UUID[i] = buffer[0];
-        }
-        UUID[10] = '\0';
-        Serial.printf("[SETUP] New UUID generated! New ID is: %s\n", UUID);
+    updateDigitalInputChannels();
 
-        data.code[0] = 34;
-        data.code[1] = 42;
-        data.code[2] = 16;
-        strcpy(data.uuid, UUID);
-    }
+    updateAnalogInputChannels();
 
-    EEPROM.put(addr, data);
-    EEPROM.commit();
+    updateReporting();
 }
 
 /*!
-    @brief Update the I2C connection
+    @brief Handles the websocket connection and sends the collected events, runs every pass of the scheduler
 */
-void checkConnectionI2C()
+void pumpNetwork()
 {
-    //Config PCA9554
-    //IO0-IO3 as input, IO4-IO7 as output.
-    Wire.beginTransmission(0x38);
-    Wire.write(byte(0x03));
-    Wire.write(byte(0x0F));
-    Wire.endTransmission();
+    webSocket.loop();
 
-    //Config MAX11647
-    Wire.beginTransmission(0x36);
-    Wire.write(byte(0xA2));
-    Wire.write(byte(0x03));
-    Wire.endTransmission();
+    // The frames collected in WSwrite_throughput mode are written by webSocket.loop() once the window has passed
+    flushEventQueue();
 }
 
 /*!
-    @brief Reads the values from the digital I2C board
-    @param[out] input0State Pointer for storing the value of input 0
-    @param[out] input1State [OPTIONAL] Pointer for storing the value of input 1
+    @brief Reads the value of a channel
+    @param[in] channel The channel of which the value is read
+    @return The value of the channel, booleans are returned as 1 or 0
 */
-void readDigitalI2CInputs(bool *input0State, bool *input1State)
+int readChannelValue(const DeviceChannel &channel)
 {
-    checkConnectionI2C();
-
-    uint8_t digitalIn;
-    bool input0, input1;
-
-    Wire.beginTransmission(0x38);
-    Wire.write(byte(0x00));
-    Wire.endTransmission();
-    Wire.requestFrom(0x38, 1);
-    digitalIn = Wire.read();
-
-    input0 = (digitalIn & 0b00000001);
-    input1 = (digitalIn & 0b00000010);
-
-    if (input0State != nullptr)
-    {
-        *input0State = input0;
-    }
-
-    if (input1State != nullptr)
+    switch (channel.type)
     {
-        *input1State = input1;
+    case CHANNEL_BOOL:
+        return *(bool *)channel.value;
+    case CHANNEL_UINT8:
+        return *(uint8_t *)channel.value;
+    case CHANNEL_UINT16:
+        return *(uint16_t *)channel.value;
     }
+    return 0;
 }
 
 /*!
-    @brief Updates the values from the digital I2C board and sends them over the websocket connection
-    @param[out] input0State Pointer for storing the value of input 0
-    @param[in] input0Command The command that is send over the websocket connection together with input 0
-    @param[out] input1State [OPTIONAL] Pointer for storing the value of input 1
-    @param[in] input1Command [OPTIONAL] The command that is send over the websocket connection together with input 1
+    @brief Writes a new value to a channel if it fits the type of the channel
+    @param[in] channel The channel that is updated
+    @param[in] value The new value, for booleans every value other than 0 is true
+    @return True if the value was written
 */
-void updateDigitalI2CInputs(bool *input0State, int input0Command, bool *input1State, int input1Command)
+bool writeChannelValue(const DeviceChannel &channel, int value)
 {
-    static bool input0_Previous = false;
-    static bool input1_Previous = false;
-    static bool firstTime = true;
-
-    if (input1State != nullptr)
-    {
-        readDigitalI2CInputs(input0State, input1State);
-    }
-    else
+    switch (channel.type)
     {
-        readDigitalI2CInputs(input0State);
-    }
-
-    if (firstTime)
-    {
-        firstTime = false;
-        input0_Previous = *input0State;
-        if (input1State != nullptr)
-            input1_Previous = *input1State;
-        return;
-    }
+    case CHANNEL_BOOL:
+        *(bool *)channel.value = (value != 0);
+        return true;
 
-    if (input0State != nullptr)
-    {
-        if (*input0State != input0_Previous || firstTime)
+    case CHANNEL_UINT8:
+        if (value < 0 || value > 255)
         {
-            Serial.printf("Switch 0 state: %d\n", *input0State);
-            input0_Previous = *input0State;
-            if (input0Command == 0)
-            {
-                Serial.printf("[ERROR] Invalid command given for switch 0\n");
-                return;
-            }
-            sendBoolMessage(input0Command, *input0State);
+            return false;
         }
-    }
+        *(uint8_t *)channel.value = value;
+        return true;
 
-    if (input1State != nullptr)
-    {
-        if (*input1State != input1_Previous || firstTime)
+    case CHANNEL_UINT16:
+        if (value < 0 || value > 65535)
         {
-            Serial.printf("Switch 1 state: %d\n", *input1State);
-            input1_Previous = *input1State;
-            if (input1Command == 0)
-            {
-                Serial.printf("[ERROR] Invalid command given for switch 1\n");
-                return;
-            }
-            sendBoolMessage(input1Command, *input1State);
+            return false;
         }
+        *(uint16_t *)channel.value = value;
+        return true;
     }
+    return false;
 }
 
 /*!
-    @brief Reads the values from the analog I2C board
-    @param[in] sampleCount The amount of samples that should be taken to get a more stable average
-    @param[out] input0Value Pointer for storing the value of input 0
-    @param[out] input1Value [OPTIONAL] Pointer for storing the value of input 1
+    @brief Interrupt that is called when a new message is received by the websocket client
+    @param[in] type Event type that is invoked, ex. CONNECTED, DISCONNECTED or new TEXT
+    @param[in] payload A pointer to the payload of the message, in this case a JSON message
+    @param[in] length Length of the message that the pointer is pointing to.
 */
-void readAnalogI2CInputs(int sampleCount, uint16_t *input0Value, uint16_t *input1Value)
+void websocketEvent(WStype_t type, uint8_t *payload, size_t length)
 {
-    checkConnectionI2C();
-
-    uint16_t analog0In, analog0Avg = 0, analog1In, analog1Avg = 0;
-
-    for (int i = 0; i < sampleCount; i++)
+    switch (type)
     {
-        Wire.requestFrom(0x36, 4);
-        analog0In = (Wire.read() & 0x03) << 8;
-        analog0In += Wire.read();
-        analog1In = (Wire.read() & 0x03) << 8;
-        analog1In += Wire.read();
-
-        analog0Avg += analog0In;
-        analog1Avg += analog1In;
-
-        delay(5);
-    }
-
-    analog0Avg /= sampleCount;
-    analog1Avg /= sampleCount;
+    case WStype_DISCONNECTED:
+        if (websocketConnected)
+        {
+            Serial.printf("[Websocket] Disconnected!\n");
+            websocketConnected = false;
+            messageProtocol = PROTOCOL_JSON;
+        }
+        break;
+    case WStype_CONNECTED:
+    {
+        Serial.printf("[Websocket] Connected!\n");
+
+        StaticJsonDocument<200> message;
+        char stringMessage[200];
+
+        message["UUID"] = UUID;
+        message["Type"] = deviceType;
+        message["command"] = REGISTRATION;
+        message["value"] = "";
+        // The protocol the device prefers, the hub may answer with PROTOCOL_JSON_BATCH or PROTOCOL_JSON instead
+        message["protocol"] = PROTOCOL_BINARY;
+
+        serializeJson(message, stringMessage);
+
+        Serial.printf("[Websocket] Sending registration: %s\n", stringMessage);
+        webSocket.sendTXT(stringMessage);
+
+        websocketConnected = true;
+        break;
+    }
+    case WStype_TEXT:
+    {
+        Serial.printf("[Websocket] New message: %s\n", payload);
+
+        DeviceMessage message;
+        if (!decodeMessage((char *)payload, &message))
+        {
+            Serial.printf("[Websocket] Invalid message format!\n");
+            break;
+        }
+
+        // The hub answers the registration with the protocol it wants to receive, a hub that does not know
+        // the protocols gets plain JSON messages
+        if (message.command == REGISTRATION)
+        {
+            messageProtocol = (message.value == PROTOCOL_BINARY || message.value == PROTOCOL_JSON_BATCH) ? message.value : PROTOCOL_JSON;
+            Serial.printf("[Websocket] Using %s protocol\n",
+                          messageProtocol == PROTOCOL_BINARY ? "binary" : messageProtocol == PROTOCOL_JSON_BATCH ? "JSON batch" : "JSON");
+            break;
+        }
+
+        handleWebsocketMessage(message);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*!
+    @brief Decodes the command and value of a flat JSON message in place, without using the heap
+    @param[in] payload The received, zero terminated payload. String values are terminated inside this buffer
+    @param[out] message The decoded command and value
+    @return True if the payload is a valid JSON object containing a command
+*/
+bool decodeMessage(char *payload, DeviceMessage *message)
+{
+    bool commandFound = false;
+    char *position = skipWhitespace(payload);
+
+    message->command = 0;
+    message->value = 0;
+    message->stringValue = nullptr;
+    message->valueCount = 0;
+
+    if (*position != '{')
+    {
+        return false;
+    }
+    position++;
+
+    while (true)
+    {
+        position = skipWhitespace(position);
+        if (*position == '}')
+        {
+            return commandFound;
+        }
+
+        char *key = position + 1;
+        position = decodeJsonString(position, true);
+        if (position == nullptr)
+        {
+            return false;
+        }
+
+        position = skipWhitespace(position);
+        if (*position != ':')
+        {
+            return false;
+        }
+        position = skipWhitespace(position + 1);
+
+        if (strcmp(key, "command") == 0)
+        {
+            position = decodeJsonValue(position, &message->command, nullptr);
+            commandFound = true;
+        }
+        else if (strcmp(key, "value") == 0 && *position == '[')
+        {
+            position = decodeJsonArray(position, message->values, &message->valueCount);
+        }
+        else if (strcmp(key, "value") == 0)
+        {
+            position = decodeJsonValue(position, &message->value, &message->stringValue);
+        }
+        else
+        {
+            position = decodeJsonValue(position, nullptr, nullptr);
+        }
+
+        if (position == nullptr)
+        {
+            return false;
+        }
+
+        position = skipWhitespace(position);
+        if (*position == ',')
+        {
+            position++;
+        }
+        else if (*position != '}')
+        {
+            return false;
+        }
+    }
+}
+
+/*!
+    @brief Decodes a single JSON value, objects and arrays are skipped
+    @param[in] position Pointer to the first character of the value
+    @param[out] number [OPTIONAL] Pointer for storing the value of a number or boolean
+    @param[out] string [OPTIONAL] Pointer for storing the start of a string, the string is terminated in place
+    @return Pointer to the first character after the value, or nullptr if the value is invalid
+*/
+char *decodeJsonValue(char *position, int *number, const char **string)
+{
+    switch (*position)
+    {
+    case '"':
+    {
+        char *start = position + 1;
+        position = decodeJsonString(position, string != nullptr);
+        if (position != nullptr && string != nullptr)
+        {
+            *string = start;
+        }
+        return position;
+    }
+
+    case '{':
+    case '[':
+    {
+        int depth = 0;
+        do
+        {
+            if (*position == '"')
+            {
+                position = decodeJsonString(position, false);
+                if (position == nullptr)
+                {
+                    return nullptr;
+                }
+                continue;
+            }
+            if (*position == '{' || *position == '[')
+            {
+                depth++;
+            }
+            else if (*position == '}' || *position == ']')
+            {
+                depth--;
+            }
+            else if (*position == '\0')
+            {
+                return nullptr;
+            }
+            position++;
+        } while (depth > 0);
+        return position;
+    }
+
+    case 't':
+        if (strncmp(position, "true", 4) != 0)
+        {
+            return nullptr;
+        }
+        if (number != nullptr)
+        {
+            *number = 1;
+        }
+        return position + 4;
+
+    case 'f':
+        if (strncmp(position, "false", 5) != 0)
+        {
+            return nullptr;
+        }
+        if (number != nullptr)
+        {
+            *number = 0;
+        }
+        return position + 5;
+
+    case 'n':
+        if (strncmp(position, "null", 4) != 0)
+        {
+            return nullptr;
+        }
+        return position + 4;
+
+    default:
+    {
+        char *end;
+        long value = strtol(position, &end, 10);
+        if (end == position)
+        {
+            return nullptr;
+        }
+        if (number != nullptr)
+        {
+            *number = value;
+        }
+
+        // Fractions and exponents are ignored, only the integer part is used
+        while (*end == '.' || *end == 'e' || *end == 'E' || *end == '+' || *end == '-' || isdigit(*end))
+        {
+            end++;
+        }
+        return end;
+    }
+    }
+}
+
+/*!
+    @brief Decodes a flat JSON array of numbers in place, elements that are not numbers or do not fit are skipped
+    @param[in] position Points to the opening bracket of the array
+    @param[out] values Array of DEVICE_MESSAGE_MAX_VALUES numbers for storing the elements
+    @param[out] valueCount Amount of elements that were stored in values
+    @return Position behind the closing bracket, or nullptr when the array is invalid
+*/
+char *decodeJsonArray(char *position, int *values, uint8_t *valueCount)
+{
+    *valueCount = 0;
+    position = skipWhitespace(position + 1);
+
+    if (*position == ']')
+    {
+        return position + 1;
+    }
+
+    while (true)
+    {
+        bool isNumber = *position == '-' || isdigit(*position);
+        int *value = (isNumber && *valueCount < DEVICE_MESSAGE_MAX_VALUES) ? &values[*valueCount] : nullptr;
+
+        position = decodeJsonValue(position, value, nullptr);
+        if (position == nullptr)
+        {
+            return nullptr;
+        }
+        if (value != nullptr)
+        {
+            (*valueCount)++;
+        }
+
+        position = skipWhitespace(position);
+        if (*position == ']')
+        {
+            return position + 1;
+        }
+        if (*position != ',')
+        {
+            return nullptr;
+        }
+        position = skipWhitespace(position + 1);
+    }
+}
+
+/*!
+    @brief Skips a JSON string, escape sequences are left as they are
+    @param[in] position Pointer to the opening quote of the string
+    @param[in] terminate Replace the closing quote with a zero so the string can be used in place
+    @return Pointer to the first character after the closing quote, or nullptr if the string is not closed
+*/
+char *decodeJsonString(char *position, bool terminate)
+{
+    if (*position != '"')
+    {
+        return nullptr;
+    }
+    position++;
+
+    while (*position != '"')
+    {
+        if (*position == '\0')
+        {
+            return nullptr;
+        }
+        if (*position == '\\' && position[1] != '\0')
+        {
+            position++;
+        }
+        position++;
+    }
+
+    if (terminate)
+    {
+        *position = '\0';
+    }
+    return position + 1;
+}
+
+/*!
+    @brief Skips spaces, tabs and newlines
+    @param[in] position Pointer to the current character
+    @return Pointer to the first character that is not whitespace
+*/
+char *skipWhitespace(char *position)
+{
+    while (*position == ' ' || *position == '\t' || *position == '\r' || *position == '\n')
+    {
+        position++;
+    }
+    return position;
+}
+
+/*!
+    @brief Queues a new message with an integer as value, it is send with the next flushEventQueue
+    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
+    @param[in] value An integer value that is send with the command as parameter.
+*/
+void sendIntMessage(int command, int value)
+{
+    queueEvent(command, BINARY_VALUE_INT, value);
+}
+
+/*!
+    @brief Queues a new message with a bool as value, it is send with the next flushEventQueue
+    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
+    @param[in] value A boolean value that is send with the command as parameter.
+*/
+void sendBoolMessage(int command, bool value)
+{
+    queueEvent(command, BINARY_VALUE_BOOL, value);
+}
+
+/*!
+    @brief Sends a new message over the Websocket connection with an string as JSON value
+    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
+    @param[in] value A string value that is send with the command as parameter.
+*/
+void sendStringMessage(int command, char *value)
+{
+    // Strings are not queued, send the queued events first so the hub receives everything in order
+    flushEventQueue(true);
+
+    if (messageProtocol == PROTOCOL_BINARY)
+    {
+        uint8_t binaryValue[BINARY_FRAME_SIZE - BINARY_FRAME_HEADER_SIZE - 2];
+        size_t stringLength = strlen(value);
+
+        if (stringLength > sizeof(binaryValue) - 1)
+        {
+            stringLength = sizeof(binaryValue) - 1;
+        }
+
+        binaryValue[0] = stringLength;
+        memcpy(&binaryValue[1], value, stringLength);
+        sendBinaryMessage(command, BINARY_VALUE_STRING, binaryValue, stringLength + 1);
+        return;
+    }
+
+    StaticJsonDocument<200> message;
+    char stringMessage[200];
+
+    message["UUID"] = UUID;
+    message["Type"] = deviceType;
+    message["command"] = command;
+    message["value"] = value;
+
+    serializeJson(message, stringMessage);
+
+    Serial.printf("Sending message: %s\n", stringMessage);
+    webSocket.sendTXT(stringMessage);
+}
+
+/*!
+    @brief Sends a single record as a binary frame, only used after the hub accepted PROTOCOL_BINARY at registration
+    @param[in] command The command send in the record, see CommandTypes.hpp
+    @param[in] valueType The type of the value, see BinaryValueTypes in CommandTypes.hpp
+    @param[in] value Pointer to the little endian encoded value
+    @param[in] valueLength The amount of bytes the value takes
+*/
+void sendBinaryMessage(int command, uint8_t valueType, const uint8_t *value, uint8_t valueLength)
+{
+    // Reserve room in front of the frame so the websocket header can be added without a copy
+    uint8_t frame[WEBSOCKETS_MAX_HEADER_SIZE + BINARY_FRAME_SIZE];
+    uint8_t *binaryMessage = &frame[WEBSOCKETS_MAX_HEADER_SIZE];
+    size_t length = BINARY_FRAME_HEADER_SIZE + 2 + valueLength;
+
+    if (length > BINARY_FRAME_SIZE)
+    {
+        Serial.printf("[ERROR] Binary value too large for command %d\n", command);
+        return;
+    }
+
+    binaryMessage[0] = BINARY_FRAME_MAGIC;
+    binaryMessage[1] = BINARY_FRAME_VERSION;
+    binaryMessage[2] = 1;
+    binaryMessage[3] = command;
+    binaryMessage[4] = valueType;
+    memcpy(&binaryMessage[5], value, valueLength);
+
+    Serial.printf("Sending binary message: command %d, %d bytes\n", command, (int)length);
+    webSocket.sendBIN(frame, length, true);
+}
+
+/*!
+    @brief Renders the part of every JSON message that never changes after initWebsocket, UUID and Type
+*/
+void renderMessageTemplate()
+{
+    StaticJsonDocument<100> message;
+    char *prefix = &messageTemplate[WEBSOCKETS_MAX_HEADER_SIZE];
+
+    message["UUID"] = UUID;
+    message["Type"] = deviceType;
+
+    // Replace the closing brace with the start of the command key
+    messageTemplateLength = serializeJson(message, prefix, MESSAGE_TEMPLATE_SIZE) - 1;
+    strcpy(&prefix[messageTemplateLength], ",\"command\":");
+    messageTemplateLength += strlen(&prefix[messageTemplateLength]);
+}
+
+/*!
+    @brief Completes the pre-rendered template with the command and value and sends it without building a JSON document
+    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
+    @param[in] value The already formatted JSON value, or nullptr to leave out the value key
+*/
+void sendTemplateMessage(int command, const char *value)
+{
+    char *payload = &messageTemplate[WEBSOCKETS_MAX_HEADER_SIZE];
+    char *tail = &payload[messageTemplateLength];
+
+    itoa(command, tail, 10);
+    tail += strlen(tail);
+
+    if (value != nullptr)
+    {
+        strcpy(tail, ",\"value\":");
+        tail += strlen(tail);
+        strcpy(tail, value);
+        tail += strlen(tail);
+    }
+
+    *tail++ = '}';
+    *tail = '\0';
+
+    if (command != HEARTBEAT)
+    {
+        Serial.printf("Sending message: %s\n", payload);
+    }
+
+    // The header is written into the reserved space in front of the payload, saving the copy in sendFrame
+    webSocket.sendTXT(messageTemplate, tail - payload, true);
+}
+
+/*!
+    @brief Adds an event to the outbound queue, a newer value for a command that is already queued replaces the old one
+    @param[in] command The command of the event, see CommandTypes.hpp
+    @param[in] valueType The type of the value, BINARY_VALUE_INT or BINARY_VALUE_BOOL
+    @param[in] value The value of the event
+*/
+void queueEvent(int command, uint8_t valueType, int32_t value)
+{
+    for (int i = 0; i < eventQueueCount; i++)
+    {
+        if (eventQueue[i].command == command)
+        {
+            eventQueue[i].valueType = valueType;
+            eventQueue[i].value = value;
+            return;
+        }
+    }
+
+    if (eventQueueCount == EVENT_QUEUE_SIZE)
+    {
+        // Queue is full, send what we have so the new event does not get lost
+        flushEventQueue(true);
+    }
+
+    if (eventQueueCount == 0)
+    {
+        eventQueueStart = millis();
+    }
+
+    eventQueue[eventQueueCount].command = command;
+    eventQueue[eventQueueCount].valueType = valueType;
+    eventQueue[eventQueueCount].value = value;
+    eventQueueCount++;
+}
+
+/*!
+    @brief Sends all queued events, in one frame when the protocol allows it, once the EVENT_QUEUE_WINDOW has passed, call once every loop
+    @param[in] force [OPTIONAL] Send the queued events even if the window has not passed yet
+*/
+void flushEventQueue(bool force)
+{
+    if (eventQueueCount == 0)
+    {
+        return;
+    }
+
+    if (!force && (millis() - eventQueueStart) < EVENT_QUEUE_WINDOW)
+    {
+        return;
+    }
+
+    if (websocketConnected)
+    {
+        if (messageProtocol == PROTOCOL_BINARY)
+        {
+            sendBinaryEvents();
+        }
+        else
+        {
+            sendJsonEvents();
+        }
+    }
+
+    eventQueueCount = 0;
+}
+
+/*!
+    @brief Sends the queued events as one binary frame with a record per event
+*/
+void sendBinaryEvents()
+{
+    uint8_t frame[WEBSOCKETS_MAX_HEADER_SIZE + BINARY_FRAME_SIZE];
+    uint8_t *binaryMessage = &frame[WEBSOCKETS_MAX_HEADER_SIZE];
+    size_t length = BINARY_FRAME_HEADER_SIZE;
+
+    binaryMessage[0] = BINARY_FRAME_MAGIC;
+    binaryMessage[1] = BINARY_FRAME_VERSION;
+    binaryMessage[2] = eventQueueCount;
+
+    for (int i = 0; i < eventQueueCount; i++)
+    {
+        binaryMessage[length++] = eventQueue[i].command;
+        binaryMessage[length++] = eventQueue[i].valueType;
+        binaryMessage[length++] = eventQueue[i].value & 0xFF;
+
+        if (eventQueue[i].valueType == BINARY_VALUE_INT)
+        {
+            binaryMessage[length++] = (eventQueue[i].value >> 8) & 0xFF;
+            binaryMessage[length++] = (eventQueue[i].value >> 16) & 0xFF;
+            binaryMessage[length++] = (eventQueue[i].value >> 24) & 0xFF;
+        }
+    }
+
+    Serial.printf("Sending binary message: %d events, %d bytes\n", eventQueueCount, (int)length);
+    webSocket.sendBIN(frame, length, true);
+}
+
+/*!
+    @brief Sends the queued events as JSON, more events as an EVENT_BATCH with [command, value] pairs if the hub accepted
+    PROTOCOL_JSON_BATCH at registration, otherwise a normal message per event
+*/
+void sendJsonEvents()
+{
+    char valueText[EVENT_QUEUE_SIZE * 20];
+
+    if (eventQueueCount == 1 || messageProtocol != PROTOCOL_JSON_BATCH)
+    {
+        for (int i = 0; i < eventQueueCount; i++)
+        {
+            formatEventValue(eventQueue[i], valueText);
+            sendTemplateMessage(eventQueue[i].command, valueText);
+        }
+        return;
+    }
+
+    char *tail = valueText;
+    *tail++ = '[';
+
+    for (int i = 0; i < eventQueueCount; i++)
+    {
+        if (i > 0)
+        {
+            *tail++ = ',';
+        }
+
+        *tail++ = '[';
+        itoa(eventQueue[i].command, tail, 10);
+        tail += strlen(tail);
+        *tail++ = ',';
+        formatEventValue(eventQueue[i], tail);
+        tail += strlen(tail);
+        *tail++ = ']';
+    }
+
+    *tail++ = ']';
+    *tail = '\0';
+
+    sendTemplateMessage(EVENT_BATCH, valueText);
+}
+
+/*!
+    @brief Formats the value of a queued event as JSON text
+    @param[in] event The event of which the value is formatted
+    @param[out] valueText Buffer for storing the text, must fit at least 12 characters
+*/
+void formatEventValue(const QueuedEvent &event, char *valueText)
+{
+    if (event.valueType == BINARY_VALUE_BOOL)
+    {
+        strcpy(valueText, event.value ? "true" : "false");
+    }
+    else
+    {
+        itoa(event.value, valueText, 10);
+    }
+}
+
+/*!
+    @brief Sends a heartbeat when connected, scheduled every HEARTBEAT_INTERVAL ms
+*/
+void sendHeartbeat()
+{
+    if (websocketConnected)
+    {
+        sendTemplateMessage(HEARTBEAT, nullptr);
+    }
+}
+
+/*!
+    @brief Read the UUID from EEPROM or generates a new one if none is present
+*/
+void generateUUID()
+{
+    uint addr = 0;
+
+    struct
+    {
+        uint8_t code[3];
+        char uuid[11] = "";
+    } data;
+
+    EEPROM.begin(512);
+    EEPROM.get(addr, data);
+
+    if (data.code[0] == 34 && data.code[1] == 42 && data.code[2] == 16)
+    {
+        strcpy(UUID, data.uuid);
+        Serial.printf("[SETUP] UUID loaded! ID is: %s\n", UUID);
+        return;
+    }
+    else
+    {
+        randomSeed(ESP.getCycleCount());
+
+        char buffer[1];
+        for (int i = 0; i < 10; i++)
+        {
+            itoa(random(9), buffer, 10);
+            UUID[i] = buffer[0];
+        }
+        UUID[10] = '\0';
+        Serial.printf("[SETUP] New UUID generated! New ID is: %s\n", UUID);
+
+        data.code[0] = 34;
+        data.code[1] = 42;
+        data.code[2] = 16;
+        strcpy(data.uuid, UUID);
+    }
+
+    EEPROM.put(addr, data);
+    EEPROM.commit();
+}
+
+/*!
+    @brief Makes sure the PCA9554 is configured, it is only configured again after a bus error or when the periodic verify fails
+    @return True if the PCA9554 is configured
+*/
+bool ensureDigitalI2C()
+{
+    if (digitalI2C.isConfigured() && millis() - lastDigitalI2CVerify > I2C_VERIFY_INTERVAL)
+    {
+        lastDigitalI2CVerify = millis();
+        digitalI2C.verify();
+        printI2CStatistics();
+    }
+
+    return digitalI2C.isConfigured() || digitalI2C.configure();
+}
+
+/*!
+    @brief Makes sure the MAX11647 is configured, it is only configured again after a bus error or when the periodic verify fails
+    @return True if the MAX11647 is configured
+*/
+bool ensureAnalogI2C()
+{
+    if (millis() - lastAnalogI2CVerify > I2C_VERIFY_INTERVAL)
+    {
+        lastAnalogI2CVerify = millis();
+
+        // The configuration of the MAX11647 is write only, so it is written again to verify it
+        analogI2C.invalidate();
+        printI2CStatistics();
+    }
+
+    return analogI2C.isConfigured() || analogI2C.configure();
+}
+
+/*!
+    @brief Prints the I2C transaction and error count, at most once every I2C_VERIFY_INTERVAL
+*/
+void printI2CStatistics()
+{
+    if (millis() - lastI2CStatistics > I2C_VERIFY_INTERVAL)
+    {
+        lastI2CStatistics = millis();
+        Serial.printf("[I2C] %u transactions, %u errors\n", i2cTransactionCount, i2cErrorCount);
+    }
+}
+
+/*!
+    @brief Fills in the runtime state of an input channel from its channel table entry
+    @param[in] channel The channel table entry
+    @param[in] threshold The amount the raw value has to change before a new update is send
+    @param[in] scale The max value that the raw 10 bit value is rescaled to, 0 keeps the raw value
+    @param[in] minSampleInterval [OPTIONAL] Time in ms between samples while the input is changing
+    @param[in] maxSampleInterval [OPTIONAL] Time in ms between samples the interval backs off to while the input is stable
+    @return The runtime state of the channel
+*/
+InputChannel makeInputChannel(const DeviceChannel &channel, uint16_t threshold, uint16_t scale, uint16_t minSampleInterval, uint16_t maxSampleInterval)
+{
+    InputChannel input;
+
+    input.command = channel.command;
+    input.type = channel.type;
+    input.io = channel.io;
+    input.value = channel.value;
+    input.previous = 0;
+    input.threshold = threshold;
+    input.scale = scale;
+    input.sum = 0;
+    input.average = 0;
+    input.sampleInterval = minSampleInterval;
+    input.minSampleInterval = minSampleInterval;
+    input.maxSampleInterval = max(minSampleInterval, maxSampleInterval);
+    input.filter = channel.filter;
+    input.latest = 0;
+    input.reported = 0;
+    input.reportableChange = 0;
+    input.minReportInterval = 0;
+    input.maxReportInterval = 0;
+    input.lastReport = 0;
+    input.reportPending = false;
+    input.initialized = false;
+
+    return input;
+}
+
+/*!
+    @brief Stores a new raw value in an input channel and sends it when it changed more than the threshold of the channel,
+    channels with a filter send the filtered value whenever the filter passes a new one
+    @param[in] input The input channel
+    @param[in] raw The new raw value
+*/
+void publishInputChannel(InputChannel &input, uint16_t raw)
+{
+    uint16_t value = raw;
+
+    if (input.filter != nullptr)
+    {
+        if (!input.filter(value) || (input.initialized && value == input.previous))
+        {
+            return;
+        }
+        raw = value;
+    }
+    else
+    {
+        if (input.initialized && abs(raw - input.previous) <= input.threshold)
+        {
+            return;
+        }
+
+        value = input.scale > 0 ? (uint32_t)raw * input.scale / 1023 : raw;
+    }
+
+    switch (input.type)
+    {
+    case CHANNEL_BOOL:
+        *(bool *)input.value = value;
+        break;
+
+    case CHANNEL_UINT8:
+        *(uint8_t *)input.value = value;
+        break;
+
+    case CHANNEL_UINT16:
+        *(uint16_t *)input.value = value;
+        break;
+    }
+
+    input.previous = raw;
+    input.latest = value;
+
+    // The first value is only stored, like a device that just started has nothing to report yet
+    if (!input.initialized)
+    {
+        input.initialized = true;
+        input.reported = value;
+        input.lastReport = millis();
+        return;
+    }
 
-    if (input0Value != nullptr)
+    // A value that went back to the reported one is not worth a report anymore
+    if (abs(value - input.reported) >= input.reportableChange)
+    {
+        input.reportPending = true;
+    }
+    else
     {
-        *input0Value = analog0Avg;
+        input.reportPending = false;
     }
+}
+
+/*!
+    @brief Sends the pending reports of all input channels once their minimal interval has passed,
+    and the values that were not reported within their maximal interval
+*/
+void updateReporting()
+{
+    InputChannel *inputs[] = {digitalInputChannels, analogInputChannels};
+    uint8_t masks[] = {digitalInputMask, analogInputMask};
+    uint8_t counts[] = {PCA9554_CHANNELS, MAX11647_CHANNELS};
 
-    if (input1Value != nullptr)
+    for (uint8_t board = 0; board < 2; board++)
     {
-        *input1Value = analog1Avg;
+        for (uint8_t io = 0; io < counts[board]; io++)
+        {
+            InputChannel &input = inputs[board][io];
+            uint32_t sinceReport = millis() - input.lastReport;
+
+            if (!(masks[board] & (1 << io)) || !input.initialized)
+            {
+                continue;
+            }
+
+            if ((input.reportPending && sinceReport >= input.minReportInterval) ||
+                (input.maxReportInterval > 0 && sinceReport >= input.maxReportInterval))
+            {
+                reportInputChannel(input);
+            }
+        }
     }
 }
 
 /*!
-    @brief Updates the values from the analog I2C board and sends them over the websocket connection
-    @param[in] sampleCount The amount of samples that should be taken to get a more stable average
-    @param[in] stabilityMargin The amount that an input can jump around before a new update is send
-    @param[in] outputScale The max value that the input should be rescaled to, ex. 255 for scaling 1023 ADC to 255
-    @param[out] input0Value Pointer for storing the value of input 0
-    @param[in] input0Command The command that is send over the websocket connection together with input 0
-    @param[out] input1Value [OPTIONAL] Pointer for storing the value of input 1
-    @param[in] input1Command [OPTIONAL] The command that is send over the websocket connection together with input 1
+    @brief Sends the latest value of an input channel, values that changed during the minimal interval are not send separately
+    @param[in] input The input channel
 */
-void updateAnalogI2CInputs(int sampleCount, int stabilityMargin, uint16_t outputScale, uint16_t *input0Value, int input0Command, uint16_t *input1Value, int input1Command)
+void reportInputChannel(InputChannel &input)
 {
-    uint16_t input0, input1;
-    static uint16_t input0_Previous = 0;
-    static uint16_t input1_Previous = 0;
-    static bool firstTime = true;
+    input.reported = input.latest;
+    input.lastReport = millis();
+    input.reportPending = false;
+
+    Serial.printf("Input %d value: %d\n", input.command, input.latest);
 
-    if (input1Value != nullptr)
+    if (input.type == CHANNEL_BOOL)
     {
-        readAnalogI2CInputs(sampleCount, &input0, &input1);
+        sendBoolMessage(input.command, input.latest);
     }
     else
     {
-        readAnalogI2CInputs(sampleCount, &input0);
+        sendIntMessage(input.command, input.latest);
+    }
+}
+
+/*!
+    @brief Finds the input channel that belongs to a command
+    @param[in] command The command of the channel
+    @return The input channel, or nullptr if the command is not an input of the device
+*/
+InputChannel *findInputChannel(int command)
+{
+    for (uint8_t io = 0; io < PCA9554_CHANNELS; io++)
+    {
+        if ((digitalInputMask & (1 << io)) && digitalInputChannels[io].command == command)
+        {
+            return &digitalInputChannels[io];
+        }
+    }
+
+    for (uint8_t io = 0; io < MAX11647_CHANNELS; io++)
+    {
+        if ((analogInputMask & (1 << io)) && analogInputChannels[io].command == command)
+        {
+            return &analogInputChannels[io];
+        }
+    }
+
+    return nullptr;
+}
+
+/*!
+    @brief Applies and stores a reporting configuration send by the hub,
+    the value is an array of [command, min interval in ms, max interval in ms, reportable change]
+    @param[in] message The REPORTING_CONFIGURATION message
+*/
+void configureReporting(const DeviceMessage &message)
+{
+    // A max interval of 0 turns the periodic report off, otherwise it can not be shorter than the min interval
+    if (message.valueCount != 4 || message.values[1] < 0 || message.values[2] < 0 || message.values[3] < 0 || message.values[3] > 0xFFFF ||
+        (message.values[2] != 0 && message.values[2] < message.values[1]))
+    {
+        Serial.printf("[Error] Invalid reporting configuration\n");
+        return;
+    }
+
+    InputChannel *input = findInputChannel(message.values[0]);
+    if (input == nullptr)
+    {
+        Serial.printf("[Error] Command %d has no reporting\n", message.values[0]);
+        return;
     }
 
-    if (firstTime)
+    input->minReportInterval = message.values[1];
+    input->maxReportInterval = message.values[2];
+    input->reportableChange = message.values[3];
+
+    Serial.printf("Reporting of %d: min %u ms, max %u ms, change %u\n", input->command, input->minReportInterval, input->maxReportInterval, input->reportableChange);
+
+    saveReportingConfiguration();
+}
+
+/*!
+    @brief Reads the reporting configuration from EEPROM and applies it to the input channels, must be called after generateUUID
+*/
+void loadReportingConfiguration()
+{
+    struct
+    {
+        uint8_t code[3];
+        uint8_t count;
+        ReportingEntry entries[REPORTING_MAX_ENTRIES];
+    } data;
+
+    EEPROM.get(REPORTING_EEPROM_ADDRESS, data);
+
+    if (data.code[0] != 34 || data.code[1] != 42 || data.code[2] != 17 || data.count > REPORTING_MAX_ENTRIES)
     {
-        firstTime = false;
+        return;
+    }
 
-        input0_Previous = input0;
-        *input0Value = input0 / 1023.0 * (float)outputScale;
+    for (uint8_t i = 0; i < data.count; i++)
+    {
+        const ReportingEntry &entry = data.entries[i];
+        InputChannel *input = findInputChannel(entry.command);
 
-        if (input1Value != nullptr)
+        if (input != nullptr)
         {
-            input1_Previous = input1;
-            *input1Value = input1 / 1023.0 * (float)outputScale;
+            input->minReportInterval = entry.minReportInterval;
+            input->maxReportInterval = entry.maxReportInterval;
+            input->reportableChange = entry.reportableChange;
         }
     }
 
-    if (input0Value != nullptr)
+    Serial.printf("[SETUP] Reporting configuration loaded for %d channels\n", data.count);
+}
+
+/*!
+    @brief Stores the reporting configuration of all input channels in EEPROM behind the UUID
+*/
+void saveReportingConfiguration()
+{
+    struct
+    {
+        uint8_t code[3] = {34, 42, 17};
+        uint8_t count = 0;
+        ReportingEntry entries[REPORTING_MAX_ENTRIES];
+    } data;
+
+    InputChannel *inputs[] = {digitalInputChannels, analogInputChannels};
+    uint8_t masks[] = {digitalInputMask, analogInputMask};
+    uint8_t counts[] = {PCA9554_CHANNELS, MAX11647_CHANNELS};
+
+    for (uint8_t board = 0; board < 2; board++)
     {
-        if (abs(input0 - input0_Previous) > stabilityMargin)
+        for (uint8_t io = 0; io < counts[board]; io++)
         {
-            input0_Previous = input0;
-            *input0Value = input0 / 1023.0 * (float)outputScale;
-            Serial.printf("Analog 0 value: %d\n", *input0Value);
-            if (input0Command == 0)
+            const InputChannel &input = inputs[board][io];
+
+            if (masks[board] & (1 << io))
             {
-                Serial.printf("[ERROR] Invalid command given for switch 0\n");
-                return;
+                ReportingEntry &entry = data.entries[data.count++];
+                entry.command = input.command;
+                entry.reportableChange = input.reportableChange;
+                entry.minReportInterval = input.minReportInterval;
+                entry.maxReportInterval = input.maxReportInterval;
             }
-            sendIntMessage(input0Command, *input0Value);
         }
     }
 
-    if (input1Value != nullptr)
+    EEPROM.put(REPORTING_EEPROM_ADDRESS, data);
+    EEPROM.commit();
+}
+
+/*!
+    @brief Reads the input port of the digital I2C board once and updates all digital input channels
+*/
+void updateDigitalInputChannels()
+{
+    if (digitalInputMask == 0 || !ensureDigitalI2C() || !digitalI2C.pollInputs())
+    {
+        return;
+    }
+
+    for (uint8_t io = 0; io < PCA9554_CHANNELS; io++)
+    {
+        if (digitalInputMask & (1 << io))
+        {
+            publishInputChannel(digitalInputChannels[io], digitalI2C.getInput(io));
+        }
+    }
+}
+
+/*!
+    @brief Takes one sample of all analog input channels when the sample interval has passed and updates
+    the channels with the average once the window of ANALOG_SAMPLE_COUNT samples is complete.
+    Only the channels that are used are converted, both channels are converted with one scan.
+*/
+void updateAnalogInputChannels()
+{
+    if (analogInputMask == 0)
+    {
+        return;
+    }
+
+    if (millis() - lastAnalogSample < analogSampleInterval)
+    {
+        return;
+    }
+    lastAnalogSample = millis();
+
+    if (!ensureAnalogI2C())
+    {
+        return;
+    }
+
+    InputChannel &input0 = analogInputChannels[0];
+    InputChannel &input1 = analogInputChannels[1];
+    uint32_t sum0 = input0.sum, sum1 = input1.sum;
+    uint8_t samples = min(ANALOG_SAMPLES_PER_READ, ANALOG_SAMPLE_COUNT - analogSamplesTaken);
+    bool success;
+
+    if (analogInputMask == 0b11)
+    {
+        success = analogI2C.readScan(samples, &input0.sum, &input1.sum);
+    }
+    else if (analogInputMask == 0b10)
+    {
+        success = analogI2C.readChannel(1, samples, &input1.sum);
+    }
+    else
+    {
+        success = analogI2C.readChannel(0, samples, &input0.sum);
+    }
+
+    if (!success)
+    {
+        return;
+    }
+
+    analogSamplesTaken += samples;
+    bool windowComplete = analogSamplesTaken >= ANALOG_SAMPLE_COUNT;
+
+    // Both channels are sampled together, so the channel that needs the fastest sampling sets the interval
+    analogSampleInterval = ANALOG_MAX_SAMPLE_INTERVAL;
+
+    for (uint8_t io = 0; io < MAX11647_CHANNELS; io++)
     {
-        if (abs(input1 - input1_Previous) > stabilityMargin)
+        InputChannel &input = analogInputChannels[io];
+
+        if (analogInputMask & (1 << io))
         {
-            input1_Previous = input1;
-            *input1Value = input1 / 1023.0 * (float)outputScale;
-            Serial.printf("Analog 1 value: %d\n", *input1Value);
-            if (input1Command == 0)
+            adaptSampleInterval(input, (input.sum - (io == 0 ? sum0 : sum1)) / samples, windowComplete);
+            analogSampleInterval = min(analogSampleInterval, input.sampleInterval);
+
+            if (windowComplete)
             {
-                Serial.printf("[ERROR] Invalid command given for switch 1\n");
-                return;
+                publishInputChannel(input, input.average);
+                input.sum = 0;
             }
-            sendIntMessage(input1Command, *input1Value);
         }
     }
+
+    if (windowComplete)
+    {
+        analogSamplesTaken = 0;
+    }
 }
 
 /*!
-    @brief Reads the values from the digital I2C board
-    @param[in] input0State Pointer pointing to the value of output 0
-    @param[in] input1State [OPTIONAL] Pointer pointing to the value of output 1
+    @brief Goes back to fast sampling as soon as a sample moves away from the last average and doubles the
+    sample interval, up to the maximum of the channel, every window in which the input stayed stable
+    @param[in] input The analog input channel
+    @param[in] sample The average of the samples that were just read
+    @param[in] windowComplete True when the window is complete, the new average is then stored in the channel
 */
-void updateDigitalI2COutputs(bool *output0State, bool *output1State)
+void adaptSampleInterval(InputChannel &input, uint16_t sample, bool windowComplete)
 {
-    checkConnectionI2C();
+    bool moving = abs(sample - input.average) > input.threshold;
 
-    uint8_t digitalOut = 0;
-    static uint8_t digitalOut_Previous = 255;
+    if (windowComplete)
+    {
+        uint16_t average = input.sum / analogSamplesTaken;
+        moving = moving || abs(average - input.average) > input.threshold;
+        input.average = average;
 
-    digitalOut += *output0State << 4;
+        if (!moving)
+        {
+            input.sampleInterval = min(input.sampleInterval * 2, (int)input.maxSampleInterval);
+            return;
+        }
+    }
 
-    if (output1State != nullptr)
+    if (moving)
     {
-        digitalOut += *output1State << 5;
+        input.sampleInterval = input.minSampleInterval;
     }
+}
 
-    if (digitalOut != digitalOut_Previous)
+/*!
+    @brief Copies all digital output channels into the output register of the digital I2C board and writes it when it changed
+*/
+void updateDigitalOutputChannels()
+{
+    if (digitalOutputMask == 0 || !ensureDigitalI2C())
     {
-        digitalOut_Previous = digitalOut;
+        return;
+    }
 
-        Wire.beginTransmission(0x38);
-        Wire.write(byte(0x01));
-        Wire.write(byte(digitalOut));
-        Wire.endTransmission();
+    for (uint8_t io = 0; io < PCA9554_CHANNELS; io++)
+    {
+        if (digitalOutputMask & (1 << io))
+        {
+            digitalI2C.setOutput(io, *digitalOutputChannels[io]);
+        }
+    }
 
+    if (digitalI2C.isOutputDirty() && digitalI2C.writeOutputs())
+    {
         Serial.printf("Outputs updated!\n");
     }
 }
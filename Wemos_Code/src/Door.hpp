@@ -2,6 +2,9 @@
 
 const char DEVICE_TYPE[] = "Door";
 
+// The door reacts to button presses, so every frame is send at once
+#define WEBSOCKET_WRITE_MODE WSwrite_lowLatency
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -18,93 +21,35 @@ bool ledInsideOn = false;
 bool ledOutsideOn = false;
 bool doorOpen = false;
 
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(DOOR_BUTTON_INSIDE_PRESSED, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 0, &buttonInsidePressed),
+    DEVICE_CHANNEL(DOOR_BUTTON_OUTSIDE_PRESSED, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 1, &buttonOutsidePressed),
+    DEVICE_CHANNEL(DOOR_LED_INSIDE_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 0, &ledInsideOn),
+    DEVICE_CHANNEL(DOOR_LED_OUTSIDE_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 1, &ledOutsideOn),
+    DEVICE_CHANNEL(DOOR_DOOR_OPEN, CHANNEL_BOOL, BINDING_SETPOINT, 0, &doorOpen)};
+
 // Forward Declaration
 
-void handleMessage(JsonObject message);
 void updateDoorPosition();
 
 // Setup
 
 void setup()
 {
-    initSerial();
-
-    initI2C();
-
-    generateUUID();
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    addTask("door", &updateDoorPosition, 20, 1000);
 }
 
 // Loop
 
 void loop()
 {
-    updateDigitalI2CInputs(&buttonInsidePressed, DOOR_BUTTON_INSIDE_PRESSED, &buttonOutsidePressed, DOOR_BUTTON_OUTSIDE_PRESSED);
-
-    updateDigitalI2COutputs(&ledInsideOn, &ledOutsideOn);
-
-    updateDoorPosition();
-
-    sendHeartbeat();
-
-    webSocket.loop();
+    runScheduler();
 }
 
 // Function definitions
 
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["DOOR_LED_INSIDE_ON"] = ledInsideOn;
-        deviceInfoMessage["DOOR_LED_OUTSIDE_ON"] = ledOutsideOn;
-        deviceInfoMessage["DOOR_DOOR_OPEN"] = doorOpen;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case DOOR_LED_INSIDE_ON:
-    {
-        ledInsideOn = (bool)message["value"];
-        break;
-    }
-
-    case DOOR_LED_OUTSIDE_ON:
-    {
-        ledOutsideOn = (bool)message["value"];
-        break;
-    }
-
-    case DOOR_DOOR_OPEN:
-    {
-        doorOpen = (bool)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
-}
-
 /*!
     @brief Checks if the LED state is still the same as the previous and updates the LED accordingly
 */
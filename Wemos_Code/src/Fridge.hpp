@@ -2,6 +2,10 @@
 
 const char DEVICE_TYPE[] = "Fridge";
 
+#define ANALOG_SAMPLE_COUNT 5
+#define ANALOG_STABILITY_MARGIN 3
+#define ANALOG_MAX_SAMPLE_INTERVAL 2000
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -15,91 +19,38 @@ uint16_t rawTemperatureSensorInsideValue = 0;
 uint16_t rawTemperatureSensorOutsideValue = 0;
 bool coolerOn = false;
 
+// The outside temperature sensor is not connected yet, it is only reported in DEVICE_INFO
+Filter<Median<5>, Ema<3>, Hysteresis<3>> temperatureInsideFilter;
+
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(FRIDGE_DOOR_CLOSED, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 0, &doorClosed),
+    DEVICE_CHANNEL(FRIDGE_FAN_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 0, &fanOn),
+    DEVICE_FILTERED_CHANNEL(FRIDGE_RAW_TEMPERATURE_SENSOR_INSIDE_VALUE, CHANNEL_UINT16, BINDING_ANALOG_INPUT, 0, &rawTemperatureSensorInsideValue, SENSOR_FILTER(temperatureInsideFilter)),
+    DEVICE_CHANNEL(FRIDGE_RAW_TEMPERATURE_SENSOR_OUTSIDE_VALUE, CHANNEL_UINT16, BINDING_STATE, 1, &rawTemperatureSensorOutsideValue),
+    DEVICE_CHANNEL(FRIDGE_COOLER_ON, CHANNEL_BOOL, BINDING_SETPOINT, 0, &coolerOn)};
+
 // Forward Declaration
 
-void handleMessage(JsonObject message);
 void UpdateCooler();
 
 // Setup
 
 void setup()
 {
-    initSerial();
-
-    initI2C();
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 
-    generateUUID();
-
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    addTask("cooler", &UpdateCooler, 100, 1000);
 }
 
 // Loop
 
 void loop()
 {
-    updateDigitalI2CInputs(&doorClosed, FRIDGE_DOOR_CLOSED);
-
-    updateAnalogI2CInputs(5, 3, 1023, &rawTemperatureSensorInsideValue, FRIDGE_RAW_TEMPERATURE_SENSOR_INSIDE_VALUE/*, &rawTemperatureSensorOutsideValue, FRIDGE_RAW_TEMPERATURE_SENSOR_OUTSIDE_VALUE*/);
-
-    updateDigitalI2COutputs(&fanOn);
-
-    UpdateCooler();
-
-    sendHeartbeat();
-
-    webSocket.loop();
+    runScheduler();
 }
 
 // Function definitions
 
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["FRIDGE_DOOR_CLOSED"] = doorClosed;
-        deviceInfoMessage["FRIDGE_FAN_ON"] = fanOn;
-        deviceInfoMessage["FRIDGE_RAW_TEMPERATURE_SENSOR_INSIDE_VALUE"] = rawTemperatureSensorInsideValue;
-        deviceInfoMessage["FRIDGE_RAW_TEMPERATURE_SENSOR_OUTSIDE_VALUE"] = rawTemperatureSensorOutsideValue;
-        deviceInfoMessage["FRIDGE_COOLER_ON"] = coolerOn;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case FRIDGE_FAN_ON:
-    {
-        fanOn = (bool)message["value"];
-        break;
-    }
-
-    case FRIDGE_COOLER_ON:
-    {
-        coolerOn = (bool)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
-}
-
 /*!
     @brief Checks if the LED state is still the same as the previous and updates the LED accordingly
 */
@@ -0,0 +1,60 @@
+#ifndef I2CBUS_HPP
+#define I2CBUS_HPP
+
+// Includes
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Global variables
+
+uint32_t i2cTransactionCount = 0;
+uint32_t i2cErrorCount = 0;
+
+// Forward Declaration
+
+bool endI2CTransmission();
+bool requestI2C(uint8_t address, uint8_t quantity);
+
+// Function definitions
+
+/*!
+    @brief Ends an I2C write transaction and keeps track of the transaction and error count
+    @return True if the transaction succeeded
+*/
+bool endI2CTransmission()
+{
+    i2cTransactionCount++;
+
+    uint8_t result = Wire.endTransmission();
+    if (result != 0)
+    {
+        i2cErrorCount++;
+        Serial.printf("[I2C] Transmission failed with error %d\n", result);
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+    @brief Requests bytes from an I2C chip and keeps track of the transaction and error count
+    @param[in] address The address of the chip
+    @param[in] quantity The amount of bytes to request
+    @return True if all requested bytes were received
+*/
+bool requestI2C(uint8_t address, uint8_t quantity)
+{
+    i2cTransactionCount++;
+
+    if (Wire.requestFrom(address, quantity) != quantity)
+    {
+        i2cErrorCount++;
+        Serial.printf("[I2C] Request from 0x%02X failed\n", address);
+        return false;
+    }
+
+    return true;
+}
+
+#endif
@@ -12,11 +12,13 @@ const char DEVICE_TYPE[] = "Lamp";
 // Global variables
 
 bool movementDetected = false;
-int ledValue = 0;
+uint8_t ledValue = 0;
 
-// Forward Declaration
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(LAMP_MOVEMENT_DETECTED, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 0, &movementDetected),
+    DEVICE_CHANNEL(LAMP_LED_VALUE, CHANNEL_UINT8, BINDING_SETPOINT, 0, &ledValue)};
 
-void handleMessage(JsonObject message);
+// Forward Declaration
 
 void updateLED();
 
@@ -24,76 +26,27 @@ void updateLED();
 
 void setup()
 {
-    initSerial();
-
-    initI2C();
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 
-    generateUUID();
-
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    addTask("led", &updateLED, 20, 1000);
 }
 
 // Loop
 
 void loop()
 {
-    updateDigitalI2CInputs(&movementDetected, LAMP_MOVEMENT_DETECTED);
-
-    updateLED();
-
-    sendHeartbeat();
-
-    webSocket.loop();
+    runScheduler();
 }
 
 // Function definitions
 
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["LAMP_LED_VALUE"] = ledValue;
-        deviceInfoMessage["LAMP_MOVEMENT_DETECTED"] = movementDetected;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case LAMP_LED_VALUE:
-    {
-        ledValue = (int)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
-}
-
 /*!
     @brief Checks if the LED state is still the same as the previous and updates the LED accordingly
 */
 void updateLED()
 {
     static bool firstTime = true;
-    static int ledValue_Previous = 0;
+    static uint8_t ledValue_Previous = 0;
 
     if (firstTime)
     {
@@ -0,0 +1,177 @@
+#ifndef MAX11647_HPP
+#define MAX11647_HPP
+
+// Defines
+
+// Setup byte: internal reference, unipolar, no reset of the configuration register
+#define MAX11647_SETUP 0xA2
+
+// Configuration byte: bit 6-5 SCAN, bit 1 CS0, bit 0 SGL
+#define MAX11647_SCAN_TO_CHANNEL 0x00 // Converts AIN0 up to the selected channel
+#define MAX11647_SCAN_SINGLE 0x60     // Converts only the selected channel
+#define MAX11647_SINGLE_ENDED 0x01
+
+#define MAX11647_CHANNELS 2
+#define MAX11647_BYTES_PER_CONVERSION 2
+#define MAX11647_UNKNOWN_CONFIG 0xFF
+
+// Size of the receive buffer of the Wire library, limits the amount of conversions per request
+#ifndef MAX11647_MAX_READ_BYTES
+#define MAX11647_MAX_READ_BYTES 32
+#endif
+
+// Includes
+
+#include "I2CBus.hpp"
+
+// Types
+
+/*!
+    @brief Driver for the MAX11647 2 channel ADC on the analog I2C board.
+    Reads a single channel when only one is needed and scans both channels otherwise. The chip keeps
+    converting as long as bytes are read, so several conversions are read back-to-back in one request
+    for oversampling. The configuration byte is shadowed and only written when the mode changes.
+*/
+class MAX11647
+{
+public:
+    MAX11647(uint8_t address) : address(address) {}
+
+    bool configure();
+    bool readChannel(uint8_t channel, uint8_t samples, uint32_t *sum);
+    bool readScan(uint8_t samples, uint32_t *sum0, uint32_t *sum1);
+
+    bool isConfigured() const { return configured; }
+    void invalidate();
+
+private:
+    bool selectConfig(uint8_t config);
+    uint16_t readConversion();
+
+    uint8_t address;
+    bool configured = false;
+    uint8_t configShadow = MAX11647_UNKNOWN_CONFIG;
+};
+
+// Function definitions
+
+/*!
+    @brief Writes the setup byte and the last used configuration byte, by default both channels are scanned
+    @return True if the chip acknowledged the configuration
+*/
+bool MAX11647::configure()
+{
+    if (configShadow == MAX11647_UNKNOWN_CONFIG)
+    {
+        configShadow = MAX11647_SCAN_TO_CHANNEL | ((MAX11647_CHANNELS - 1) << 1) | MAX11647_SINGLE_ENDED;
+    }
+
+    Wire.beginTransmission(address);
+    Wire.write(byte(MAX11647_SETUP));
+    Wire.write(byte(configShadow));
+    if (!endI2CTransmission())
+    {
+        invalidate();
+        return false;
+    }
+
+    configured = true;
+    return true;
+}
+
+/*!
+    @brief Converts one channel a number of times in a single request
+    @param[in] channel The channel to convert, 0 for AIN0 or 1 for AIN1
+    @param[in] samples The amount of conversions to read
+    @param[out] sum The sum of all conversions
+    @return True if all conversions were read
+*/
+bool MAX11647::readChannel(uint8_t channel, uint8_t samples, uint32_t *sum)
+{
+    samples = constrain(samples, 1, MAX11647_MAX_READ_BYTES / MAX11647_BYTES_PER_CONVERSION);
+
+    if (!selectConfig(MAX11647_SCAN_SINGLE | (channel << 1) | MAX11647_SINGLE_ENDED) ||
+        !requestI2C(address, samples * MAX11647_BYTES_PER_CONVERSION))
+    {
+        invalidate();
+        return false;
+    }
+
+    for (uint8_t i = 0; i < samples; i++)
+    {
+        *sum += readConversion();
+    }
+
+    return true;
+}
+
+/*!
+    @brief Scans both channels a number of times in a single request
+    @param[in] samples The amount of scans to read
+    @param[out] sum0 The sum of all conversions of AIN0
+    @param[out] sum1 The sum of all conversions of AIN1
+    @return True if all scans were read
+*/
+bool MAX11647::readScan(uint8_t samples, uint32_t *sum0, uint32_t *sum1)
+{
+    samples = constrain(samples, 1, MAX11647_MAX_READ_BYTES / (MAX11647_BYTES_PER_CONVERSION * MAX11647_CHANNELS));
+
+    if (!selectConfig(MAX11647_SCAN_TO_CHANNEL | ((MAX11647_CHANNELS - 1) << 1) | MAX11647_SINGLE_ENDED) ||
+        !requestI2C(address, samples * MAX11647_BYTES_PER_CONVERSION * MAX11647_CHANNELS))
+    {
+        invalidate();
+        return false;
+    }
+
+    for (uint8_t i = 0; i < samples; i++)
+    {
+        *sum0 += readConversion();
+        *sum1 += readConversion();
+    }
+
+    return true;
+}
+
+/*!
+    @brief Marks the chip as unconfigured after a bus error, it is configured again on the next check
+*/
+void MAX11647::invalidate()
+{
+    configured = false;
+}
+
+/*!
+    @brief Writes the configuration byte when it differs from the one the chip already has
+    @param[in] config The configuration byte
+    @return True if the chip has the configuration
+*/
+bool MAX11647::selectConfig(uint8_t config)
+{
+    if (configShadow == config)
+    {
+        return true;
+    }
+
+    Wire.beginTransmission(address);
+    Wire.write(byte(config));
+    if (!endI2CTransmission())
+    {
+        return false;
+    }
+
+    configShadow = config;
+    return true;
+}
+
+/*!
+    @brief Reads one 10 bit conversion from the receive buffer, the upper 6 bits of the first byte are always high
+    @return The conversion result
+*/
+uint16_t MAX11647::readConversion()
+{
+    uint16_t value = (Wire.read() & 0x03) << 8;
+    value += Wire.read();
+    return value;
+}
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef PCA9554_HPP
+#define PCA9554_HPP
+
+// Defines
+
+#define PCA9554_INPUT_REGISTER 0x00
+#define PCA9554_OUTPUT_REGISTER 0x01
+#define PCA9554_CONFIG_REGISTER 0x03
+
+// IO0-IO3 are inputs, IO4-IO7 are outputs
+#define PCA9554_INPUT_MASK 0x0F
+#define PCA9554_OUTPUT_SHIFT 4
+#define PCA9554_CHANNELS 4
+
+#define PCA9554_UNKNOWN_REGISTER 0xFF
+
+// Time in ms after which the input port is read even without an interrupt, in case an edge was missed
+#ifndef PCA9554_FALLBACK_POLL_INTERVAL
+#define PCA9554_FALLBACK_POLL_INTERVAL 1000
+#endif
+
+// Includes
+
+#include "I2CBus.hpp"
+
+// Types
+
+/*!
+    @brief Driver for the PCA9554 I/O expander on the digital I2C board.
+    The outputs are kept in a shadow register that is only written when it changed, and the register
+    pointer of the chip is tracked so reading the input port costs a single request when the pointer
+    is already on the input register.
+*/
+class PCA9554
+{
+public:
+    PCA9554(uint8_t address) : address(address) {}
+
+    bool configure();
+    bool verify();
+    bool readInputs();
+    bool pollInputs();
+    bool writeOutputs();
+
+    void attachInterruptPin(uint8_t pin);
+
+    bool getInput(uint8_t index) const { return inputPort & (1 << index); }
+    void setOutput(uint8_t index, bool state);
+
+    bool isOutputDirty() const { return outputDirty; }
+    bool isConfigured() const { return configured; }
+    void invalidate();
+
+private:
+    bool selectRegister(uint8_t reg);
+
+    static void onInterrupt();
+    static volatile bool inputChanged;
+
+    uint8_t address;
+    uint8_t inputPort = 0;
+    uint8_t outputShadow = 0;
+    bool outputDirty = true;
+    bool configured = false;
+    uint8_t registerPointer = PCA9554_UNKNOWN_REGISTER;
+    bool interruptAttached = false;
+    uint32_t lastInputRead = 0;
+};
+
+// Global variables
+
+volatile bool PCA9554::inputChanged = true;
+
+// Function definitions
+
+/*!
+    @brief Configures IO0-IO3 as input and IO4-IO7 as output, the outputs are written again on the next writeOutputs
+    @return True if the chip acknowledged the configuration
+*/
+bool PCA9554::configure()
+{
+    Wire.beginTransmission(address);
+    Wire.write(byte(PCA9554_CONFIG_REGISTER));
+    Wire.write(byte(PCA9554_INPUT_MASK));
+    if (!endI2CTransmission())
+    {
+        invalidate();
+        return false;
+    }
+
+    registerPointer = PCA9554_CONFIG_REGISTER;
+    outputDirty = true;
+    configured = true;
+
+    // The INT line may already be asserted, so the input port has to be read once
+    inputChanged = true;
+    return true;
+}
+
+/*!
+    @brief Reads the configuration register back to check if the chip still holds its configuration
+    @return True if the configuration is still correct
+*/
+bool PCA9554::verify()
+{
+    if (!selectRegister(PCA9554_CONFIG_REGISTER) || !requestI2C(address, 1))
+    {
+        invalidate();
+        return false;
+    }
+
+    if (Wire.read() != PCA9554_INPUT_MASK)
+    {
+        configured = false;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+    @brief Reads the input port
+    @return True if the input port was read
+*/
+bool PCA9554::readInputs()
+{
+    if (!selectRegister(PCA9554_INPUT_REGISTER) || !requestI2C(address, 1))
+    {
+        invalidate();
+        return false;
+    }
+
+    inputPort = Wire.read();
+    lastInputRead = millis();
+    return true;
+}
+
+/*!
+    @brief Reads the input port only when the INT line signalled a change or the fallback poll interval passed,
+    without an interrupt pin every call reads the input port
+    @return True if the input port was read
+*/
+bool PCA9554::pollInputs()
+{
+    if (interruptAttached && !inputChanged && millis() - lastInputRead < PCA9554_FALLBACK_POLL_INTERVAL)
+    {
+        return false;
+    }
+
+    // Cleared before reading, so an edge during the read triggers another read
+    inputChanged = false;
+
+    if (!readInputs())
+    {
+        inputChanged = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+    @brief Uses the open drain INT output of the chip to detect input changes instead of polling
+    @param[in] pin The GPIO the INT output is connected to
+*/
+void PCA9554::attachInterruptPin(uint8_t pin)
+{
+    pinMode(pin, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(pin), onInterrupt, FALLING);
+    interruptAttached = true;
+    inputChanged = true;
+}
+
+/*!
+    @brief Called when the INT line goes low, reading the input port releases it again
+*/
+void ICACHE_RAM_ATTR PCA9554::onInterrupt()
+{
+    inputChanged = true;
+}
+
+/*!
+    @brief Writes the output shadow register to the chip when it changed
+    @return True if the outputs are up to date
+*/
+bool PCA9554::writeOutputs()
+{
+    if (!outputDirty)
+    {
+        return true;
+    }
+
+    Wire.beginTransmission(address);
+    Wire.write(byte(PCA9554_OUTPUT_REGISTER));
+    Wire.write(byte(outputShadow));
+    if (!endI2CTransmission())
+    {
+        invalidate();
+        return false;
+    }
+
+    registerPointer = PCA9554_OUTPUT_REGISTER;
+    outputDirty = false;
+    return true;
+}
+
+/*!
+    @brief Changes one output in the shadow register, it is written on the next writeOutputs
+    @param[in] index The output, 0-3 for IO4-IO7
+    @param[in] state The new state of the output
+*/
+void PCA9554::setOutput(uint8_t index, bool state)
+{
+    uint8_t mask = 1 << (index + PCA9554_OUTPUT_SHIFT);
+    uint8_t output = state ? (outputShadow | mask) : (outputShadow & ~mask);
+
+    if (output != outputShadow)
+    {
+        outputShadow = output;
+        outputDirty = true;
+    }
+}
+
+/*!
+    @brief Marks the chip as unconfigured after a bus error, it is configured again on the next check
+*/
+void PCA9554::invalidate()
+{
+    configured = false;
+    registerPointer = PCA9554_UNKNOWN_REGISTER;
+}
+
+/*!
+    @brief Points the register pointer of the chip to a register, skipped when it already points there
+    @param[in] reg The register to select
+    @return True if the register is selected
+*/
+bool PCA9554::selectRegister(uint8_t reg)
+{
+    if (registerPointer == reg)
+    {
+        return true;
+    }
+
+    Wire.beginTransmission(address);
+    Wire.write(byte(reg));
+    if (!endI2CTransmission())
+    {
+        return false;
+    }
+
+    registerPointer = reg;
+    return true;
+}
+
+#endif
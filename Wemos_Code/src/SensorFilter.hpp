@@ -0,0 +1,165 @@
+#ifndef SENSORFILTER_HPP
+#define SENSORFILTER_HPP
+
+// Defines
+
+// Turns a filter object into the function pointer that is stored in the channel table
+#define SENSOR_FILTER(object) (&applySensorFilter<decltype(object), &object>)
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+/*!
+    @brief Filter chain that passes a value through every stage in order, for example
+    Filter<Median<5>, Ema<2>, Hysteresis<8>, Scale<1023, 255>>. All stages are resolved at compile time
+    and only use integer math. A stage returns false to stop the chain, the value is then not published.
+*/
+template <typename... Stages>
+class Filter;
+
+template <>
+class Filter<>
+{
+public:
+    bool apply(uint16_t &) { return true; }
+};
+
+template <typename Stage, typename... Rest>
+class Filter<Stage, Rest...>
+{
+public:
+    bool apply(uint16_t &value) { return stage.apply(value) && rest.apply(value); }
+
+private:
+    Stage stage;
+    Filter<Rest...> rest;
+};
+
+/*!
+    @brief Replaces the value with the median of the last N values, removes single spikes
+*/
+template <uint8_t N>
+class Median
+{
+    static_assert(N > 0 && N <= 15, "The median window has to be between 1 and 15 values");
+
+public:
+    bool apply(uint16_t &value)
+    {
+        window[next] = value;
+        next = (next + 1) % N;
+        if (count < N)
+        {
+            count++;
+        }
+
+        uint16_t sorted[N];
+        for (uint8_t i = 0; i < count; i++)
+        {
+            uint16_t current = window[i];
+            uint8_t j = i;
+
+            for (; j > 0 && sorted[j - 1] > current; j--)
+            {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = current;
+        }
+
+        value = sorted[count / 2];
+        return true;
+    }
+
+private:
+    uint16_t window[N];
+    uint8_t count = 0;
+    uint8_t next = 0;
+};
+
+/*!
+    @brief Exponential moving average with a weight of 1/2^K for the new value, kept in fixed point
+*/
+template <uint8_t K>
+class Ema
+{
+    static_assert(K > 0 && K < 16, "The EMA shift has to be between 1 and 15");
+
+public:
+    bool apply(uint16_t &value)
+    {
+        if (!primed)
+        {
+            primed = true;
+            state = (uint32_t)value << K;
+        }
+        else
+        {
+            state = state - (state >> K) + value;
+        }
+
+        value = (state + (1 << (K - 1))) >> K;
+        return true;
+    }
+
+private:
+    uint32_t state = 0;
+    bool primed = false;
+};
+
+/*!
+    @brief Only passes a value when it differs more than B from the last value that was passed
+*/
+template <uint16_t B>
+class Hysteresis
+{
+public:
+    bool apply(uint16_t &value)
+    {
+        if (primed && abs(value - last) <= B)
+        {
+            return false;
+        }
+
+        primed = true;
+        last = value;
+        return true;
+    }
+
+private:
+    uint16_t last = 0;
+    bool primed = false;
+};
+
+/*!
+    @brief Rescales a value from 0-In to 0-Out, the division by a constant is turned into a multiplication by the compiler
+*/
+template <uint16_t In, uint16_t Out>
+class Scale
+{
+    static_assert(In > 0, "The input range can not be zero");
+
+public:
+    bool apply(uint16_t &value)
+    {
+        value = (uint32_t)min(value, In) * Out / In;
+        return true;
+    }
+};
+
+// Function definitions
+
+/*!
+    @brief Runs a filter object, instantiated for every filter so no virtual dispatch is needed
+    @param[in,out] value The value that is filtered
+    @return True if the filtered value should be published
+*/
+template <typename T, T *object>
+bool applySensorFilter(uint16_t &value)
+{
+    return object->apply(value);
+}
+
+#endif
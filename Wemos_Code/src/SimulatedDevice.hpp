@@ -9,6 +9,12 @@ const char DEVICE_TYPE[] = "SimulatedDevice";
 #define PIN_LED2 12 //D6
 #define PIN_LED3 13 //D7
 
+#define BUTTON_COUNT 2
+#define BUTTON_DEBOUNCE_TIME 50
+
+// Amount of button edges the interrupt can store before the loop has to drain them, must be a power of two
+#define BUTTON_EDGE_BUFFER_SIZE 16
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -20,11 +26,35 @@ uint8_t LED1_Value = 0;
 uint8_t LED2_Value = 0;
 uint8_t LED3_Value = 0;
 
+// Single-producer/single-consumer ring filled by the button interrupts and drained by handleButtons.
+// The GPIO interrupts do not nest, so both buttons share one producer.
+struct ButtonEdge
+{
+    uint32_t timestamp;
+    uint8_t button;
+    uint8_t level;
+};
+
+volatile ButtonEdge buttonEdges[BUTTON_EDGE_BUFFER_SIZE];
+volatile uint8_t buttonEdgeHead = 0;
+volatile uint8_t buttonEdgeTail = 0;
+volatile bool buttonEdgeOverflow = false;
+
+const uint8_t BUTTON_PINS[BUTTON_COUNT] = {PIN_BUTTON_1, PIN_BUTTON_2};
+const int BUTTON_COMMANDS[BUTTON_COUNT] = {SIMULATED_BUTTON1_PRESSED, SIMULATED_BUTTON2_PRESSED};
+
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(SIMULATED_LED1_VALUE, CHANNEL_UINT8, BINDING_SETPOINT, 0, &LED1_Value),
+    DEVICE_CHANNEL(SIMULATED_LED2_VALUE, CHANNEL_UINT8, BINDING_SETPOINT, 0, &LED2_Value),
+    DEVICE_CHANNEL(SIMULATED_LED3_VALUE, CHANNEL_UINT8, BINDING_SETPOINT, 0, &LED3_Value)};
+
 // Forward Declaration
 
 void initPins();
 
-void handleMessage(JsonObject message);
+void pushButtonEdge(uint8_t button);
+void onButton1Change();
+void onButton2Change();
 void handleButtons();
 void handlePotmeter();
 void handleLEDs();
@@ -33,30 +63,20 @@ void handleLEDs();
 
 void setup()
 {
-    initSerial();
-
     initPins();
 
-    generateUUID();
-
-    initWifi();
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    addTask("buttons", &handleButtons, 10, 1000);
+    addTask("potmeter", &handlePotmeter, 50, 1000);
+    addTask("leds", &handleLEDs, 20, 1000);
 }
 
 // Loop
 
 void loop()
 {
-    handleButtons();
-
-    handlePotmeter();
-
-    handleLEDs();
-
-    sendHeartbeat();
-
-    webSocket.loop();
+    runScheduler();
 }
 
 // Function definitions
@@ -74,96 +94,111 @@ void initPins()
     pinMode(PIN_LED1, OUTPUT);
     pinMode(PIN_LED2, OUTPUT);
     pinMode(PIN_LED3, OUTPUT);
+
+    attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_1), onButton1Change, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_2), onButton2Change, CHANGE);
 }
 
 /*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
+    @brief Stores a timestamped edge of a button in the edge ring, called from interrupt context
+    @param[in] button The index of the button in BUTTON_PINS
 */
-void handleMessage(JsonObject message)
+void ICACHE_RAM_ATTR pushButtonEdge(uint8_t button)
 {
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["SIMULATED_LED1_VALUE"] = LED1_Value;
-        deviceInfoMessage["SIMULATED_LED2_VALUE"] = LED2_Value;
-        deviceInfoMessage["SIMULATED_LED3_VALUE"] = LED3_Value;
-
-        serializeJson(deviceInfoMessage, stringMessage);
+    uint8_t head = buttonEdgeHead;
+    uint8_t next = (head + 1) & (BUTTON_EDGE_BUFFER_SIZE - 1);
 
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
+    if (next == buttonEdgeTail)
+    {
+        buttonEdgeOverflow = true;
+        return;
     }
-    case SIMULATED_LED1_VALUE:
-        if ((int)message["value"] <= 255 && (int)message["value"] >= 0)
-        {
-            LED1_Value = (int)message["value"];
-        }
-        break;
 
-    case SIMULATED_LED2_VALUE:
-        if ((int)message["value"] <= 255 && (int)message["value"] >= 0)
-        {
-            LED2_Value = (int)message["value"];
-        }
-        break;
+    buttonEdges[head].timestamp = millis();
+    buttonEdges[head].button = button;
+    buttonEdges[head].level = digitalRead(BUTTON_PINS[button]);
 
-    case SIMULATED_LED3_VALUE:
-        if ((int)message["value"] <= 255 && (int)message["value"] >= 0)
-        {
-            LED3_Value = (int)message["value"];
-        }
-        break;
+    // Publish the edge only after it is completely written
+    buttonEdgeHead = next;
+}
 
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
+void ICACHE_RAM_ATTR onButton1Change()
+{
+    pushButtonEdge(0);
+}
+
+void ICACHE_RAM_ATTR onButton2Change()
+{
+    pushButtonEdge(1);
 }
 
 /*!
-    @brief Reads all the buttons and sends an update if something changed
+    @brief Drains the button edges captured by the interrupts, debounces them and sends an update if a button changed.
+    The first edge after a quiet period is accepted immediately with its own timestamp, edges within
+    BUTTON_DEBOUNCE_TIME after it are treated as bounce. If the last edge left the button in another state,
+    that state is accepted once the pin has been quiet for the debounce time, so short presses are never lost.
 */
 void handleButtons()
 {
     static bool firstTime = true;
-    int button_1_State = 1;
-    static int button_1_PreviousState = 1;
-    int button_2_State = 1;
-    static int button_2_PreviousState = 1;
-
-    button_1_State = digitalRead(PIN_BUTTON_1);
-    button_2_State = digitalRead(PIN_BUTTON_2);
-
-    delay(50); // Simple debounce
+    static uint8_t stableLevel[BUTTON_COUNT];
+    static uint8_t lastLevel[BUTTON_COUNT];
+    static uint32_t lastEdgeTime[BUTTON_COUNT];
+    static uint32_t acceptedTime[BUTTON_COUNT];
 
     if (firstTime)
     {
         firstTime = false;
-        button_1_PreviousState = button_1_State;
-        button_2_PreviousState = button_2_State;
+        for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+        {
+            stableLevel[i] = lastLevel[i] = digitalRead(BUTTON_PINS[i]);
+            acceptedTime[i] = lastEdgeTime[i] = millis();
+        }
+        buttonEdgeTail = buttonEdgeHead;
         return;
     }
 
-    if (button_1_State != button_1_PreviousState)
+    while (buttonEdgeTail != buttonEdgeHead)
     {
-        Serial.printf("Buttons 1 state: %d\n", button_1_State);
-        button_1_PreviousState = button_1_State;
-        sendBoolMessage(SIMULATED_BUTTON1_PRESSED, !button_1_State);
+        uint8_t tail = buttonEdgeTail;
+        uint32_t timestamp = buttonEdges[tail].timestamp;
+        uint8_t button = buttonEdges[tail].button;
+        uint8_t level = buttonEdges[tail].level;
+
+        buttonEdgeTail = (tail + 1) & (BUTTON_EDGE_BUFFER_SIZE - 1);
+
+        lastLevel[button] = level;
+        lastEdgeTime[button] = timestamp;
+
+        if (level != stableLevel[button] && timestamp - acceptedTime[button] >= BUTTON_DEBOUNCE_TIME)
+        {
+            stableLevel[button] = level;
+            acceptedTime[button] = timestamp;
+            Serial.printf("Buttons %d state: %d at %u ms\n", button + 1, level, timestamp);
+            sendBoolMessage(BUTTON_COMMANDS[button], !level);
+        }
+    }
+
+    // Edges were dropped, the pin itself is the only reliable state left
+    if (buttonEdgeOverflow)
+    {
+        buttonEdgeOverflow = false;
+        for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+        {
+            lastLevel[i] = digitalRead(BUTTON_PINS[i]);
+            lastEdgeTime[i] = millis();
+        }
     }
 
-    if (button_2_State != button_2_PreviousState)
+    for (uint8_t i = 0; i < BUTTON_COUNT; i++)
     {
-        Serial.printf("Buttons 2 state: %d\n", button_2_State);
-        button_2_PreviousState = button_2_State;
-        sendBoolMessage(SIMULATED_BUTTON2_PRESSED, !button_2_State);
+        if (lastLevel[i] != stableLevel[i] && millis() - lastEdgeTime[i] >= BUTTON_DEBOUNCE_TIME)
+        {
+            stableLevel[i] = lastLevel[i];
+            acceptedTime[i] = lastEdgeTime[i];
+            Serial.printf("Buttons %d state: %d at %u ms\n", i + 1, lastLevel[i], lastEdgeTime[i]);
+            sendBoolMessage(BUTTON_COMMANDS[i], !lastLevel[i]);
+        }
     }
 }
 
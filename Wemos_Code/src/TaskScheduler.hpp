@@ -0,0 +1,181 @@
+#ifndef TASKSCHEDULER_HPP
+#define TASKSCHEDULER_HPP
+
+// Defines
+
+// Maximum amount of tasks that can be registered
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 8
+#endif
+
+// Interval in ms in which the task statistics are printed, 0 disables printing
+#ifndef SCHEDULER_STATISTICS_INTERVAL
+#define SCHEDULER_STATISTICS_INTERVAL 0
+#endif
+
+#define TASK_HIGH_PRIORITY true
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+struct ScheduledTask
+{
+    const char *name;
+    void (*callback)();
+    uint32_t period;        // Time in ms between two runs, 0 runs the task every pass
+    uint32_t budget;        // Time in us the task may take before it counts as an overrun
+    bool highPriority;      // High priority tasks run every time they are due, others share one slot per pass
+    uint32_t nextRun;       // millis() timestamp of the next deadline
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t worstLateness; // Worst time in ms a task started after its deadline
+    uint32_t worstDuration; // Worst time in us a task took to run
+};
+
+// Global variables
+
+ScheduledTask scheduledTasks[SCHEDULER_MAX_TASKS];
+uint8_t scheduledTaskCount = 0;
+
+// Forward Declaration
+
+bool addTask(const char *name, void (*callback)(), uint32_t period, uint32_t budget, bool highPriority = false);
+void runScheduler();
+void runTask(ScheduledTask &task, uint32_t now);
+void printSchedulerStatistics();
+
+// Function definitions
+
+/*!
+    @brief Registers a task that is run periodically by runScheduler
+    @param[in] name Name of the task, used when printing the statistics
+    @param[in] callback Function that is called when the task is due
+    @param[in] period Time in ms between two runs, 0 runs the task every pass
+    @param[in] budget Time in us the task may take before it counts as an overrun
+    @param[in] highPriority [OPTIONAL] Runs the task every time it is due instead of sharing a slot with the other tasks
+    @return True if the task is registered, false if there is no room left
+*/
+bool addTask(const char *name, void (*callback)(), uint32_t period, uint32_t budget, bool highPriority)
+{
+    if (scheduledTaskCount >= SCHEDULER_MAX_TASKS)
+    {
+        Serial.printf("[ERROR] No room left for task %s\n", name);
+        return false;
+    }
+
+    ScheduledTask &task = scheduledTasks[scheduledTaskCount++];
+    task.name = name;
+    task.callback = callback;
+    task.period = period;
+    task.budget = budget;
+    task.highPriority = highPriority;
+    task.nextRun = millis();
+    task.runs = 0;
+    task.overruns = 0;
+    task.worstLateness = 0;
+    task.worstDuration = 0;
+
+    return true;
+}
+
+/*!
+    @brief Runs one pass of the scheduler, call this from loop()
+    All due high priority tasks are run, of the other due tasks only the one that is most overdue is run,
+    so a slow sensor task can never delay the next high priority task by more than its own run time.
+*/
+void runScheduler()
+{
+    ScheduledTask *mostOverdue = nullptr;
+    int32_t mostLateness = -1;
+
+    for (uint8_t i = 0; i < scheduledTaskCount; i++)
+    {
+        ScheduledTask &task = scheduledTasks[i];
+        uint32_t now = millis();
+        int32_t lateness = (int32_t)(now - task.nextRun);
+
+        if (lateness < 0)
+        {
+            continue;
+        }
+
+        if (task.highPriority)
+        {
+            runTask(task, now);
+        }
+        else if (lateness > mostLateness)
+        {
+            mostOverdue = &task;
+            mostLateness = lateness;
+        }
+    }
+
+    if (mostOverdue != nullptr)
+    {
+        runTask(*mostOverdue, millis());
+    }
+
+#if SCHEDULER_STATISTICS_INTERVAL > 0
+    static uint32_t lastStatistics = 0;
+
+    if (millis() - lastStatistics > SCHEDULER_STATISTICS_INTERVAL)
+    {
+        lastStatistics = millis();
+        printSchedulerStatistics();
+    }
+#endif
+}
+
+/*!
+    @brief Runs a single task and updates its deadline and statistics
+    @param[in] task The task that is due
+    @param[in] now The current millis() timestamp
+*/
+void runTask(ScheduledTask &task, uint32_t now)
+{
+    uint32_t lateness = now - task.nextRun;
+    uint32_t start = micros();
+
+    task.callback();
+
+    uint32_t duration = micros() - start;
+
+    task.runs++;
+    if (task.period > 0 && lateness > task.worstLateness)
+    {
+        task.worstLateness = lateness;
+    }
+    if (duration > task.worstDuration)
+    {
+        task.worstDuration = duration;
+    }
+    if (duration > task.budget)
+    {
+        task.overruns++;
+    }
+
+    // Skip the deadlines that were missed instead of running the task several times in a row
+    task.nextRun += task.period;
+    if ((int32_t)(millis() - task.nextRun) >= 0)
+    {
+        task.nextRun = millis() + task.period;
+    }
+}
+
+/*!
+    @brief Prints the run count, overruns and worst case timing of every task
+*/
+void printSchedulerStatistics()
+{
+    for (uint8_t i = 0; i < scheduledTaskCount; i++)
+    {
+        const ScheduledTask &task = scheduledTasks[i];
+        Serial.printf("[Task] %s: runs %u, overruns %u, worst lateness %u ms, worst duration %u us (budget %u us)\n",
+                      task.name, task.runs, task.overruns, task.worstLateness, task.worstDuration, task.budget);
+    }
+}
+
+#endif
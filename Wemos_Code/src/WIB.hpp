@@ -2,6 +2,10 @@
 
 const char DEVICE_TYPE[] = "WIB";
 
+#define ANALOG_SAMPLE_COUNT 5
+#define ANALOG_STABILITY_MARGIN 8
+#define ANALOG_MAX_SAMPLE_INTERVAL 80
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -13,76 +17,23 @@ bool switchOn = false;
 bool ledOn = false;
 uint16_t dimmerValue = 0;
 
-// Forward Declaration
+Filter<Median<3>, Hysteresis<8>, Scale<1023, 255>> dimmerFilter;
 
-void handleMessage(JsonObject message);
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(WIB_SWITCH_ON, CHANNEL_BOOL, BINDING_DIGITAL_INPUT, 0, &switchOn),
+    DEVICE_CHANNEL(WIB_LED_ON, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 0, &ledOn),
+    DEVICE_FILTERED_CHANNEL(WIB_DIMMER_VALUE, CHANNEL_UINT16, BINDING_ANALOG_INPUT, 0, &dimmerValue, SENSOR_FILTER(dimmerFilter))};
 
 // Setup
 
 void setup()
 {
-    initSerial();
-
-    initI2C();
-
-    generateUUID();
-
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 }
 
 // Loop
 
 void loop()
 {
-    updateDigitalI2CInputs(&switchOn, WIB_SWITCH_ON);
-
-    updateAnalogI2CInputs(5, 8, 255, &dimmerValue, WIB_DIMMER_VALUE);
-
-    updateDigitalI2COutputs(&ledOn);
-
-    sendHeartbeat();
-
-    webSocket.loop();
-}
-
-// Function definitions
-
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["WIB_SWITCH_ON"] = switchOn;
-        deviceInfoMessage["WIB_LED_ON"] = ledOn;
-        deviceInfoMessage["WIB_DIMMER_VALUE"] = dimmerValue;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case WIB_LED_ON:
-    {
-        ledOn = (bool)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
+    runScheduler();
 }
@@ -4,6 +4,10 @@ const char DEVICE_TYPE[] = "Wall";
 
 #define NUMBER_OF_LEDS 3
 
+#define ANALOG_SAMPLE_COUNT 10
+#define ANALOG_STABILITY_MARGIN 20
+#define ANALOG_MAX_SAMPLE_INTERVAL 80
+
 //Includes
 
 #include "CommandTypes.hpp"
@@ -14,11 +18,18 @@ const char DEVICE_TYPE[] = "Wall";
 bool curtainOpen = false;
 uint16_t LDRValue = 0;
 uint16_t dimmerValue = 0;
-int ledstripValue = 0;
+uint8_t ledstripValue = 0;
 
-// Forward Declaration
+Filter<Median<3>, Hysteresis<20>, Scale<1023, 255>> dimmerFilter;
+Filter<Median<3>, Ema<2>, Hysteresis<20>, Scale<1023, 255>> LDRFilter;
 
-void handleMessage(JsonObject message);
+constexpr DeviceChannel DEVICE_CHANNELS[] = {
+    DEVICE_CHANNEL(WALL_CURTAIN_OPEN, CHANNEL_BOOL, BINDING_DIGITAL_OUTPUT, 0, &curtainOpen),
+    DEVICE_FILTERED_CHANNEL(WALL_DIMMER_VALUE, CHANNEL_UINT16, BINDING_ANALOG_INPUT, 1, &dimmerValue, SENSOR_FILTER(dimmerFilter)),
+    DEVICE_FILTERED_CHANNEL(WALL_LDR_VALUE, CHANNEL_UINT16, BINDING_ANALOG_INPUT, 0, &LDRValue, SENSOR_FILTER(LDRFilter)),
+    DEVICE_CHANNEL(WALL_LEDSTRIP_VALUE, CHANNEL_UINT8, BINDING_SETPOINT, 0, &ledstripValue)};
+
+// Forward Declaration
 
 void updateLedstrip();
 
@@ -26,84 +37,26 @@ void updateLedstrip();
 
 void setup()
 {
-    initSerial();
+    initDevice(DEVICE_TYPE, DEVICE_CHANNELS);
 
-    initI2C();
-
-    generateUUID();
-
-    initWifi();
-
-    initWebsocket(&handleMessage, DEVICE_TYPE);
+    addTask("ledstrip", &updateLedstrip, 20, 1000);
 }
 
 // Loop
 
 void loop()
 {
-    updateAnalogI2CInputs(10, 20, 255, &LDRValue, WALL_LDR_VALUE, &dimmerValue, WALL_DIMMER_VALUE);
-
-    updateDigitalI2COutputs(&curtainOpen);
-
-    updateLedstrip();
-
-    sendHeartbeat();
-
-    webSocket.loop();
+    runScheduler();
 }
 
 // Function definitions
 
-/*!
-    @brief Reads the incoming message and activates the actuators or sends devices information back.
-*/
-void handleMessage(JsonObject message)
-{
-    switch ((int)message["command"])
-    {
-    case DEVICE_INFO:
-    {
-        StaticJsonDocument<200> deviceInfoMessage;
-        char stringMessage[200];
-
-        deviceInfoMessage["UUID"] = UUID;
-        deviceInfoMessage["Type"] = DEVICE_TYPE;
-        deviceInfoMessage["command"] = DEVICE_INFO;
-        deviceInfoMessage["WALL_CURTAIN_OPEN"] = curtainOpen;
-        deviceInfoMessage["WALL_DIMMER_VALUE"] = dimmerValue;
-        deviceInfoMessage["WALL_LDR_VALUE"] = LDRValue;
-
-        serializeJson(deviceInfoMessage, stringMessage);
-
-        Serial.printf("Sending DEVICE_INFO: %s\n", stringMessage);
-        webSocket.sendTXT(stringMessage);
-        break;
-    }
-
-    case WALL_CURTAIN_OPEN:
-    {
-        curtainOpen = (bool)message["value"];
-        break;
-    }
-
-    case WALL_LEDSTRIP_VALUE:
-    {
-        ledstripValue = (int)message["value"];
-        break;
-    }
-
-    default:
-        Serial.printf("[Error] Unsupported command received: %d\n", (int)message["command"]);
-        break;
-    }
-}
-
 /*!
     @brief Checks if the ledstrip state is still the same as the previous and updates the ledstrip accordingly
 */
 void updateLedstrip()
 {
-    static int ledstrip_Previous = 0;
+    static uint8_t ledstrip_Previous = 0;
 
     if (ledstripValue != ledstrip_Previous)
     {
@@ -0,0 +1,43 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+// Defines
+
+// Prints a formatted line with the test output, on the device it goes over the serial port
+#define BENCHMARK_MESSAGE(...)                                       \
+    do                                                               \
+    {                                                                \
+        char benchmarkLine[160];                                     \
+        snprintf(benchmarkLine, sizeof(benchmarkLine), __VA_ARGS__); \
+        TEST_MESSAGE(benchmarkLine);                                 \
+    } while (0)
+
+// Includes
+
+#include <Arduino.h>
+#include <unity.h>
+
+#if !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+// Function definitions
+
+/*!
+    @brief Reads a free running cycle counter: the CPU cycle counter on the ESP8266, the time stamp counter
+    on an x86 host and nanoseconds elsewhere. Only the difference of two counts is meaningful, keep the
+    measured section well below 2^32 counts.
+    @return The current count
+*/
+inline uint32_t benchmarkCycles()
+{
+#if defined(ARDUINO)
+    return ESP.getCycleCount();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef HUBCONNECTION_HPP
+#define HUBCONNECTION_HPP
+
+// Includes
+
+#include <WebSocketsClient.h>
+#include <string>
+#include <vector>
+
+// Types
+
+// A frame the client wrote, with the mask removed
+struct SentFrame
+{
+    uint8_t opcode;
+    bool fin; // Last frame of the message
+    bool compressed; // RSV1, the payload is deflated
+    std::string payload;
+};
+
+/*!
+    @brief Opens a WebSocketsClient on the host WiFiClient without a handshake, as if the hub accepted the
+    connection, so the firmware sends its messages as on the device. What is sent ends up in
+    WiFiClient::transmitted(). Only used by the native tests.
+*/
+struct HubConnection : WebSocketsClient
+{
+    /*!
+        @brief Opens the connection of a client
+        @param[in] client The client to open, the webSocket of DefaultFunctions.hpp
+        @param[in] deflateBits [OPTIONAL] Window bits of permessage-deflate for the messages the client sends, 0 leaves it off
+        @param[in] deflateTakeover [OPTIONAL] Keep the deflate window between messages
+    */
+    static void open(WebSocketsClient &client, uint8_t deflateBits = 0, bool deflateTakeover = true)
+    {
+        WSclient_t &state = client.*(&HubConnection::_client);
+
+#if defined(HAS_SSL)
+        state.isSSL = false;
+        state.ssl = NULL;
+#endif
+        // A global client is zero initialized, when it is opened again the connection is reused
+        if (state.tcp == NULL)
+        {
+            state.tcp = new WEBSOCKETS_NETWORK_CLASS();
+        }
+        state.tcp->connect("10.0.1.1", 9002);
+
+        if (deflateBits != 0)
+        {
+            (client.*(&HubConnection::deflateInit))(&state, deflateBits, deflateTakeover, 15, true);
+        }
+        else
+        {
+            (client.*(&HubConnection::releaseDeflate))(&state);
+        }
+
+        (client.*(&HubConnection::headerDone))(&state);
+        WiFiClient::transmitted().clear();
+        WiFiClient::received().clear();
+    }
+
+    /*!
+        @brief Splits what the client wrote into frames and removes the mask
+        @return The frames in the order they were written
+    */
+    static std::vector<SentFrame> sentFrames()
+    {
+        const std::string &bytes = WiFiClient::transmitted();
+        std::vector<SentFrame> frames;
+        size_t position = 0;
+
+        while (position + 2 <= bytes.size())
+        {
+            SentFrame frame;
+            uint8_t first = bytes[position];
+            uint8_t second = bytes[position + 1];
+            uint64_t length = second & 0x7F;
+            position += 2;
+
+            frame.opcode = first & 0x0F;
+            frame.fin = (first & 0x80) != 0;
+            frame.compressed = (first & 0x40) != 0;
+
+            int extendedLength = length == 126 ? 2 : length == 127 ? 8 : 0;
+            if (extendedLength != 0)
+            {
+                length = 0;
+                for (int i = 0; i < extendedLength; i++)
+                {
+                    length = (length << 8) | (uint8_t)bytes[position++];
+                }
+            }
+
+            const char *maskKey = (second & 0x80) ? &bytes[position] : nullptr;
+            position += maskKey ? 4 : 0;
+
+            frame.payload = bytes.substr(position, length);
+            for (size_t i = 0; maskKey && i < frame.payload.size(); i++)
+            {
+                frame.payload[i] ^= maskKey[i & 3];
+            }
+            position += length;
+
+            frames.push_back(frame);
+        }
+        return frames;
+    }
+};
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Host replacement for the parts of the ESP8266 Arduino core that the firmware and the WebSockets library
+// use in the native tests. Hardware access does nothing, time and text behave as on the device.
+
+// Defines
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define bit(b) (1UL << (b))
+#define F(string) string
+#define PROGMEM
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+#define RANDOM_REG32 ((uint32_t)rand())
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define A0 17
+#define D1 5
+#define D2 4
+#define D5 14
+#define D6 12
+#define D7 13
+
+// Includes
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+using std::abs;
+using std::max;
+using std::min;
+
+// Types
+
+typedef uint8_t byte;
+
+/*!
+    @brief The Arduino String on top of std::string
+*/
+class String
+{
+public:
+    String(const char *text = "") : text(text ? text : "") {}
+    String(const std::string &text) : text(text) {}
+    String(char character) : text(1, character) {}
+    String(int value) : text(std::to_string(value)) {}
+    String(unsigned int value) : text(std::to_string(value)) {}
+    String(long value) : text(std::to_string(value)) {}
+    String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char *c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool reserve(unsigned int size)
+    {
+        text.reserve(size);
+        return true;
+    }
+
+    // As in the ESP8266 core a String is only false when its allocation failed
+    explicit operator bool() const { return true; }
+
+    char operator[](unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char &operator[](unsigned int index) { return text[index]; }
+
+    String &operator+=(const String &other)
+    {
+        text += other.text;
+        return *this;
+    }
+    String &operator+=(const char *other)
+    {
+        text += other;
+        return *this;
+    }
+    String &operator+=(char other)
+    {
+        text += other;
+        return *this;
+    }
+    bool concat(const char *other, unsigned int length)
+    {
+        text.append(other, length);
+        return true;
+    }
+
+    friend String operator+(const String &left, const String &right) { return String(left.text + right.text); }
+    friend String operator+(const String &left, const char *right) { return String(left.text + right); }
+    friend String operator+(const char *left, const String &right) { return String(left + right.text); }
+
+    bool operator==(const String &other) const { return text == other.text; }
+    bool operator==(const char *other) const { return text == other; }
+    bool operator!=(const String &other) const { return text != other.text; }
+    bool operator!=(const char *other) const { return text != other; }
+
+    bool equalsIgnoreCase(const String &other) const
+    {
+        return text.size() == other.text.size() && strncasecmp(text.c_str(), other.text.c_str(), text.size()) == 0;
+    }
+    bool startsWith(const String &prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return text.size() >= suffix.text.size() && text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+    }
+
+    int indexOf(char character, unsigned int from = 0) const { return position(text.find(character, from)); }
+    int indexOf(const String &other, unsigned int from = 0) const { return position(text.find(other.text, from)); }
+    String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < text.size() && from < to ? String(text.substr(from, to - from)) : String();
+    }
+
+    void remove(unsigned int index) { remove(index, text.size()); }
+    void remove(unsigned int index, unsigned int count)
+    {
+        if (index < text.size())
+        {
+            text.erase(index, count);
+        }
+    }
+    void trim()
+    {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        size_t last = text.find_last_not_of(" \t\r\n");
+        text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    }
+    void toLowerCase()
+    {
+        for (char &character : text)
+        {
+            character = tolower(character);
+        }
+    }
+    long toInt() const { return atol(text.c_str()); }
+
+private:
+    static int position(size_t index) { return index == std::string::npos ? -1 : (int)index; }
+
+    std::string text;
+};
+
+/*!
+    @brief Serial port that drops its output, the tests report through Unity
+*/
+class HardwareSerial
+{
+public:
+    void begin(unsigned long) {}
+    size_t printf(const char *, ...) __attribute__((format(printf, 2, 3))) { return 0; }
+    template <typename T>
+    size_t print(const T &) { return 0; }
+    template <typename T>
+    size_t println(const T &) { return 0; }
+    size_t println() { return 0; }
+};
+
+/*!
+    @brief The ESP class, heap statistics are not available on the host
+*/
+class EspClass
+{
+public:
+    uint32_t getFreeHeap() { return 0; }
+    uint32_t getMaxFreeBlockSize() { return 0; }
+    uint8_t getHeapFragmentation() { return 0; }
+    uint32_t getCycleCount() { return 0; }
+    void restart() { exit(1); }
+};
+
+// Global variables
+
+static HardwareSerial Serial __attribute__((unused));
+static EspClass ESP __attribute__((unused));
+
+// Function definitions
+
+inline unsigned long millis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline unsigned long micros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {}
+
+// The ESP8266 core has itoa in stdlib_noniso.h, glibc does not
+inline char *itoa(int value, char *text, int radix)
+{
+    static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    unsigned int magnitude = (value < 0 && radix == 10) ? -(unsigned int)value : (unsigned int)value;
+    char *position = text;
+
+    do
+    {
+        *position++ = digits[magnitude % radix];
+        magnitude /= radix;
+    } while (magnitude != 0);
+
+    if (value < 0 && radix == 10)
+    {
+        *position++ = '-';
+    }
+    *position = '\0';
+    std::reverse(text, position);
+    return text;
+}
+
+inline long random(long min, long max)
+{
+    return min < max ? min + rand() % (max - min) : min;
+}
+
+inline long random(long max)
+{
+    return random(0, max);
+}
+
+inline void randomSeed(unsigned long seed)
+{
+    srand(seed);
+}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline int analogRead(uint8_t) { return 0; }
+inline void analogWrite(uint8_t, int) {}
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t, void (*)(), int) {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+/*!
+    @brief Emulated EEPROM in RAM, it starts erased as a new device
+*/
+class EEPROMClass
+{
+public:
+    EEPROMClass() { memset(data, 0xFF, sizeof(data)); }
+
+    void begin(size_t) {}
+    bool commit() { return true; }
+
+    template <typename T>
+    T &get(int address, T &value)
+    {
+        memcpy(&value, &data[address], sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &value)
+    {
+        memcpy(&data[address], &value, sizeof(T));
+        return value;
+    }
+
+private:
+    uint8_t data[4096];
+};
+
+// Global variables
+
+static EEPROMClass EEPROM __attribute__((unused));
+
+#endif
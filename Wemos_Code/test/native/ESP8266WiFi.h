@@ -0,0 +1,126 @@
+#ifndef ESP8266WIFI_H
+#define ESP8266WIFI_H
+
+// Defines
+
+#define WIFI_STA 1
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+// Includes
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Types
+
+/*!
+    @brief TCP client without a network. Connecting always succeeds, written bytes are collected in
+    transmitted() so the tests can measure what goes over the wire, bytes put in received() are read as if
+    the hub sent them.
+*/
+class WiFiClient
+{
+public:
+    virtual ~WiFiClient() {}
+
+    static std::string &transmitted()
+    {
+        // Never destroyed, global clients still write their close frame when the program exits
+        static std::string *bytes = new std::string();
+        return *bytes;
+    }
+
+    static std::string &received()
+    {
+        static std::string *bytes = new std::string();
+        return *bytes;
+    }
+
+    virtual int connect(const char *, uint16_t)
+    {
+        open = true;
+        return 1;
+    }
+    virtual int connect(IPAddress, uint16_t)
+    {
+        open = true;
+        return 1;
+    }
+    virtual uint8_t connected() { return open; }
+    virtual int available() { return open ? received().size() : 0; }
+    virtual int read()
+    {
+        uint8_t data;
+        return read(&data, 1) == 1 ? data : -1;
+    }
+    virtual int read(uint8_t *data, size_t length)
+    {
+        length = std::min(length, (size_t)available());
+        received().copy((char *)data, length);
+        received().erase(0, length);
+        return length;
+    }
+    virtual int peek() { return available() ? (uint8_t)received()[0] : -1; }
+    virtual size_t write(uint8_t data) { return write(&data, 1); }
+    virtual size_t write(const uint8_t *data, size_t length)
+    {
+        if (!open)
+        {
+            return 0;
+        }
+        transmitted().append((const char *)data, length);
+        return length;
+    }
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    virtual void flush() {}
+    virtual void stop() { open = false; }
+
+    void setTimeout(unsigned long) {}
+    void setNoDelay(bool noDelay) { this->noDelay = noDelay; }
+    bool getNoDelay() { return noDelay; }
+    String readStringUntil(char) { return String(); }
+    IPAddress remoteIP() { return IPAddress(); }
+    uint16_t remotePort() { return 0; }
+
+private:
+    bool open = false;
+    bool noDelay = false;
+};
+
+class WiFiClientSecure : public WiFiClient
+{
+public:
+    bool verify(const char *, const char *) { return false; }
+    void setInsecure() {}
+    void setFingerprint(const char *) {}
+    bool setCACert(const uint8_t *, size_t) { return false; }
+};
+
+class WiFiServer
+{
+public:
+    WiFiServer(uint16_t) {}
+    WiFiServer(IPAddress, uint16_t) {}
+
+    void begin() {}
+    void close() {}
+    bool hasClient() { return false; }
+    WiFiClient available() { return WiFiClient(); }
+};
+
+class ESP8266WiFiClass
+{
+public:
+    void mode(int) {}
+    void begin(const char *, const char *) {}
+    int status() { return WL_DISCONNECTED; }
+    IPAddress localIP() { return IPAddress(); }
+    String macAddress() { return String("00:00:00:00:00:00"); }
+};
+
+// Global variables
+
+static ESP8266WiFiClass WiFi __attribute__((unused));
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef FASTLED_H
+#define FASTLED_H
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+struct CRGB
+{
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+struct WS2812
+{
+};
+
+struct GRB
+{
+};
+
+class CFastLED
+{
+public:
+    template <typename Chipset, uint8_t dataPin, typename ColorOrder>
+    CFastLED &addLeds(CRGB *, int) { return *this; }
+    void show() {}
+};
+
+// Global variables
+
+static CFastLED FastLED __attribute__((unused));
+
+#endif
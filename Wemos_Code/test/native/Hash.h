@@ -0,0 +1,22 @@
+#ifndef HASH_H
+#define HASH_H
+
+// Includes
+
+#include <Arduino.h>
+
+// Function definitions
+
+/*!
+    @brief SHA-1 of a string as the ESP8266 core provides it. The host tests never complete a WebSocket
+    handshake, so the digest is left zero.
+    @param[in] data The string to hash
+    @param[out] hash 20 byte buffer for the digest
+*/
+inline void sha1(const String &data, uint8_t hash[20])
+{
+    (void)data;
+    memset(hash, 0, 20);
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef IPADDRESS_H
+#define IPADDRESS_H
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+/*!
+    @brief IPv4 address, the host tests never connect so it stays 0.0.0.0
+*/
+class IPAddress
+{
+public:
+    IPAddress(uint8_t first = 0, uint8_t second = 0, uint8_t third = 0, uint8_t fourth = 0) : octets{first, second, third, fourth} {}
+
+    uint8_t operator[](int index) const { return octets[index]; }
+    String toString() const
+    {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+        return String(text);
+    }
+
+private:
+    uint8_t octets[4];
+};
+
+#endif
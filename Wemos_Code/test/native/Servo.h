@@ -0,0 +1,21 @@
+#ifndef SERVO_H
+#define SERVO_H
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+class Servo
+{
+public:
+    uint8_t attach(int) { return 0; }
+    void write(int angle) { this->angle = angle; }
+    int read() { return angle; }
+
+private:
+    int angle = 0;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+// Includes
+
+#include <Arduino.h>
+
+// Types
+
+/*!
+    @brief I2C bus without chips, every transmission is acknowledged and reads return nothing
+*/
+class TwoWire
+{
+public:
+    void begin() {}
+    void begin(int, int) {}
+    void setClock(uint32_t) {}
+    void beginTransmission(uint8_t) {}
+    size_t write(uint8_t) { return 1; }
+    uint8_t endTransmission(bool = true) { return 0; }
+    uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+// Global variables
+
+static TwoWire Wire __attribute__((unused));
+
+#endif
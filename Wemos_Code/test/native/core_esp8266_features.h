@@ -0,0 +1,6 @@
+#ifndef CORE_ESP8266_FEATURES_H
+#define CORE_ESP8266_FEATURES_H
+
+// The host has none of the core features, the header only has to exist
+
+#endif
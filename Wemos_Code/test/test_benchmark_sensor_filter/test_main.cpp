@@ -0,0 +1,148 @@
+// Defines
+
+#define SAMPLE_COUNT 4096
+#define OLD_STABILITY_MARGIN 8
+#define OLD_OUTPUT_SCALE 255
+
+// Includes
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "SensorFilter.hpp"
+#include "../Benchmark.hpp"
+
+// Global variables
+
+uint16_t samples[SAMPLE_COUNT];
+
+// Function definitions
+
+void setUp() {}
+
+void tearDown() {}
+
+/*!
+    @brief Fills the sample buffer with a slow ramp on the pressure sensor range, with a few counts of
+    noise on every sample and a full scale spike every 97 samples. The signal is the same on every run.
+*/
+void generateSamples()
+{
+    uint32_t seed = 12345;
+
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        int noise = (int)((seed >> 16) % 13) - 6;
+        int value = 200 + (i * 600) / SAMPLE_COUNT + noise;
+
+        if (i % 97 == 0)
+        {
+            value = 1023;
+        }
+        samples[i] = (uint16_t)constrain(value, 0, 1023);
+    }
+}
+
+/*!
+    @brief The analog path before the sensor filters: a margin against the last published raw value and
+    a float division to scale it, as in the old updateAnalogInputChannels
+    @param[out] updates The number of values that would have been published
+    @return The last published value
+*/
+uint16_t runOldPath(uint32_t &updates)
+{
+    int previous = 0;
+    uint16_t value = 0;
+    bool firstTime = true;
+
+    updates = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        int input = samples[i];
+
+        if (firstTime || abs(input - previous) > OLD_STABILITY_MARGIN)
+        {
+            firstTime = false;
+            previous = input;
+            value = input / 1023.0 * (float)OLD_OUTPUT_SCALE;
+            updates++;
+        }
+    }
+    return value;
+}
+
+/*!
+    @brief The filter chain that replaced it on the bed pressure sensor
+    @param[out] updates The number of values that would have been published
+    @return The last published value
+*/
+uint16_t runFilterPath(uint32_t &updates)
+{
+    Filter<Median<3>, Ema<2>, Hysteresis<8>, Scale<1023, 255>> pressureFilter;
+    uint16_t value = 0;
+
+    updates = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        uint16_t input = samples[i];
+
+        if (pressureFilter.apply(input))
+        {
+            value = input;
+            updates++;
+        }
+    }
+    return value;
+}
+
+void test_benchmark_filter_against_float_path()
+{
+    uint32_t oldUpdates, filterUpdates;
+    uint32_t oldCycles = UINT32_MAX, filterCycles = UINT32_MAX;
+    volatile uint16_t sink;
+
+    generateSamples();
+
+    // Take the best of a few runs so an interrupt or a cold cache does not end up in the result
+    for (int run = 0; run < 5; run++)
+    {
+        uint32_t start = benchmarkCycles();
+        sink = runOldPath(oldUpdates);
+        oldCycles = min(oldCycles, benchmarkCycles() - start);
+
+        start = benchmarkCycles();
+        sink = runFilterPath(filterUpdates);
+        filterCycles = min(filterCycles, benchmarkCycles() - start);
+    }
+    (void)sink;
+
+    BENCHMARK_MESSAGE("float path: %u cycles per sample, %u updates", (unsigned)(oldCycles / SAMPLE_COUNT), (unsigned)oldUpdates);
+    BENCHMARK_MESSAGE("filter chain: %u cycles per sample, %u updates", (unsigned)(filterCycles / SAMPLE_COUNT), (unsigned)filterUpdates);
+
+    // Every spike passes the old margin twice, on the way up and on the way back down
+    TEST_ASSERT_LESS_THAN(oldUpdates, filterUpdates);
+}
+
+int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_filter_against_float_path);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    // Give the serial monitor time to connect
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main()
+{
+    return runTests();
+}
+#endif
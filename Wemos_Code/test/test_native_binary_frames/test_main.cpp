@@ -0,0 +1,209 @@
+// Defines
+
+#define MESSAGE_COUNT 500
+
+// Includes
+
+#include "DefaultFunctions.hpp"
+
+#include <unity.h>
+
+#include "../Benchmark.hpp"
+#include "../HubConnection.hpp"
+
+// Function definitions
+
+void setUp()
+{
+    WiFiClient::transmitted().clear();
+    eventQueueCount = 0;
+}
+
+void tearDown() {}
+
+/*!
+    @brief Sends a batch of telemetry events the way the channel updates do
+    @param[in] eventCount The amount of events in the batch
+    @param[in] round Changes the values between batches
+*/
+void sendTelemetry(uint8_t eventCount, int round)
+{
+    static const int commands[] = {BED_PRESSURE_SENSOR_VALUE, CHAIR_PRESSURE_SENSOR_VALUE, COLUMN_SMOKE_SENSOR_VALUE, WALL_LDR_VALUE};
+
+    for (int i = 0; i < eventCount; i++)
+    {
+        sendIntMessage(commands[i], (round * 37 + i * 101) % 1024);
+    }
+    flushEventQueue(true);
+}
+
+void test_binary_frame_layout()
+{
+    messageProtocol = PROTOCOL_BINARY;
+    sendIntMessage(BED_PRESSURE_SENSOR_VALUE, 300);
+    sendBoolMessage(BED_BUTTON_PRESSED, true);
+    flushEventQueue(true);
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+    const uint8_t expected[] = {BINARY_FRAME_MAGIC, BINARY_FRAME_VERSION, 2,
+                                BED_PRESSURE_SENSOR_VALUE, BINARY_VALUE_INT, 0x2C, 0x01, 0x00, 0x00,
+                                BED_BUTTON_PRESSED, BINARY_VALUE_BOOL, 1};
+
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(WSop_binary, frames[0].opcode);
+    TEST_ASSERT_EQUAL(sizeof(expected), frames[0].payload.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected, frames[0].payload.data(), sizeof(expected));
+}
+
+void test_json_without_binary_protocol()
+{
+    messageProtocol = PROTOCOL_JSON;
+    sendIntMessage(BED_PRESSURE_SENSOR_VALUE, 300);
+    flushEventQueue(true);
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(WSop_text, frames[0].opcode);
+    TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":42,\"value\":300}", frames[0].payload.c_str());
+}
+
+/*!
+    @brief Lets the firmware handle a message as if the hub sent it
+    @param[in] text The JSON message
+*/
+void receiveMessage(const char *text)
+{
+    char payload[100];
+
+    strcpy(payload, text);
+    websocketEvent(WStype_TEXT, (uint8_t *)payload, strlen(payload));
+}
+
+void test_protocol_from_registration()
+{
+    receiveMessage("{\"command\":21,\"value\":1}");
+    TEST_ASSERT_EQUAL(PROTOCOL_BINARY, messageProtocol);
+
+    receiveMessage("{\"command\":21,\"value\":2}");
+    TEST_ASSERT_EQUAL(PROTOCOL_JSON_BATCH, messageProtocol);
+
+    // A hub that does not know the protocols answers without a known value
+    receiveMessage("{\"command\":21,\"value\":\"\"}");
+    TEST_ASSERT_EQUAL(PROTOCOL_JSON, messageProtocol);
+
+    receiveMessage("{\"command\":21,\"value\":7}");
+    TEST_ASSERT_EQUAL(PROTOCOL_JSON, messageProtocol);
+
+    messageProtocol = PROTOCOL_JSON_BATCH;
+    websocketEvent(WStype_DISCONNECTED, nullptr, 0);
+    websocketConnected = true;
+    TEST_ASSERT_EQUAL(PROTOCOL_JSON, messageProtocol);
+}
+
+void test_json_batch_only_when_accepted()
+{
+    messageProtocol = PROTOCOL_JSON;
+    sendIntMessage(BED_PRESSURE_SENSOR_VALUE, 300);
+    sendBoolMessage(BED_BUTTON_PRESSED, true);
+    flushEventQueue(true);
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+    TEST_ASSERT_EQUAL(2, frames.size());
+    TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":42,\"value\":300}", frames[0].payload.c_str());
+    TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":40,\"value\":true}", frames[1].payload.c_str());
+
+    WiFiClient::transmitted().clear();
+    messageProtocol = PROTOCOL_JSON_BATCH;
+    sendIntMessage(BED_PRESSURE_SENSOR_VALUE, 300);
+    sendBoolMessage(BED_BUTTON_PRESSED, true);
+    flushEventQueue(true);
+
+    frames = HubConnection::sentFrames();
+
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":23,\"value\":[[42,300],[40,true]]}", frames[0].payload.c_str());
+}
+
+void test_string_after_queued_events()
+{
+    char text[] = "Bed";
+    const uint8_t protocols[] = {PROTOCOL_JSON, PROTOCOL_BINARY};
+
+    for (uint8_t protocol : protocols)
+    {
+        WiFiClient::transmitted().clear();
+        messageProtocol = protocol;
+        sendIntMessage(BED_PRESSURE_SENSOR_VALUE, 300);
+        sendStringMessage(DEVICE_INFO, text);
+
+        std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+        TEST_ASSERT_EQUAL(0, eventQueueCount);
+        TEST_ASSERT_EQUAL(2, frames.size());
+        if (protocol == PROTOCOL_BINARY)
+        {
+            TEST_ASSERT_EQUAL(BED_PRESSURE_SENSOR_VALUE, (uint8_t)frames[0].payload[BINARY_FRAME_HEADER_SIZE]);
+            TEST_ASSERT_EQUAL(DEVICE_INFO, (uint8_t)frames[1].payload[BINARY_FRAME_HEADER_SIZE]);
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":42,\"value\":300}", frames[0].payload.c_str());
+            TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":22,\"value\":\"Bed\"}", frames[1].payload.c_str());
+        }
+    }
+}
+
+void test_benchmark_binary_against_json()
+{
+    const uint8_t batchSizes[] = {1, 4};
+    const uint8_t protocols[] = {PROTOCOL_JSON, PROTOCOL_JSON_BATCH, PROTOCOL_BINARY};
+    const char *protocolNames[] = {"JSON", "JSON batch", "binary"};
+
+    for (uint8_t eventCount : batchSizes)
+    {
+        size_t wireBytes[3];
+
+        for (int p = 0; p < 3; p++)
+        {
+            messageProtocol = protocols[p];
+            WiFiClient::transmitted().clear();
+
+            uint32_t start = benchmarkCycles();
+            for (int round = 0; round < MESSAGE_COUNT; round++)
+            {
+                sendTelemetry(eventCount, round);
+            }
+            uint32_t cycles = benchmarkCycles() - start;
+
+            wireBytes[p] = WiFiClient::transmitted().size() / MESSAGE_COUNT;
+            BENCHMARK_MESSAGE("%s, %u events: %u byte on the wire, %u cycles to encode and send", protocolNames[p], eventCount,
+                              (unsigned)wireBytes[p], (unsigned)(cycles / MESSAGE_COUNT));
+        }
+
+        TEST_ASSERT_LESS_OR_EQUAL(wireBytes[0], wireBytes[1]);
+        TEST_ASSERT_LESS_THAN(wireBytes[1], wireBytes[2]);
+    }
+}
+
+int main()
+{
+    strcpy(UUID, "0123456789");
+    deviceType = "Bed";
+    websocketConnected = true;
+    renderMessageTemplate();
+
+    // Every frame is written at once so the bytes can be counted per message
+    webSocket.setWriteMode(WSwrite_lowLatency);
+    HubConnection::open(webSocket);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_binary_frame_layout);
+    RUN_TEST(test_json_without_binary_protocol);
+    RUN_TEST(test_protocol_from_registration);
+    RUN_TEST(test_json_batch_only_when_accepted);
+    RUN_TEST(test_string_after_queued_events);
+    RUN_TEST(test_benchmark_binary_against_json);
+    return UNITY_END();
+}
@@ -0,0 +1,186 @@
+// Defines
+
+#define DECODE_ROUNDS 2000
+
+// Includes
+
+#include "DefaultFunctions.hpp"
+
+#include <unity.h>
+
+#include "../Benchmark.hpp"
+
+// Types
+
+/*!
+    @brief The allocator of DynamicJsonDocument, counting what the documents take from the heap
+*/
+struct CountingAllocator
+{
+    static uint32_t allocations;
+    static uint32_t bytes;
+
+    void *allocate(size_t size)
+    {
+        allocations++;
+        bytes += size;
+        return malloc(size);
+    }
+
+    void deallocate(void *pointer)
+    {
+        free(pointer);
+    }
+
+    void *reallocate(void *pointer, size_t size)
+    {
+        allocations++;
+        return realloc(pointer, size);
+    }
+};
+
+uint32_t CountingAllocator::allocations = 0;
+uint32_t CountingAllocator::bytes = 0;
+
+// Global variables
+
+// Messages as the hub sends them
+const char *const hubMessages[] = {
+    "{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":41,\"value\":true}",
+    "{\"UUID\":\"0123456789\",\"Type\":\"SimulatedDevice\",\"command\":102,\"value\":512}",
+    "{\"command\":21,\"value\":1}",
+    "{\"command\":20,\"value\":\"\"}",
+    "{ \"command\" : 92 , \"value\" : false }",
+};
+
+const int expectedCommands[] = {41, 102, 21, 20, 92};
+const int expectedValues[] = {1, 512, 1, 0, 0};
+
+char payload[200];
+
+// Function definitions
+
+void setUp() {}
+
+void tearDown() {}
+
+/*!
+    @brief The decoding from before decodeMessage: a DynamicJsonDocument of 1024 byte for every message
+    @param[in] text The received payload, it is used in place like the websocket payload
+    @param[out] command The command of the message
+    @param[out] value The value of the message
+    @return True if the payload is valid JSON
+*/
+bool decodeWithDocument(char *text, int *command, int *value)
+{
+    BasicJsonDocument<CountingAllocator> doc(1024);
+
+    if (deserializeJson(doc, text))
+    {
+        return false;
+    }
+
+    JsonObject message = doc.as<JsonObject>();
+    *command = message["command"].as<int>();
+    *value = message["value"].as<int>();
+    return true;
+}
+
+void test_decode_matches_document()
+{
+    for (size_t i = 0; i < sizeof(hubMessages) / sizeof(hubMessages[0]); i++)
+    {
+        DeviceMessage message;
+        int command, value;
+
+        strcpy(payload, hubMessages[i]);
+        TEST_ASSERT_TRUE(decodeWithDocument(payload, &command, &value));
+
+        strcpy(payload, hubMessages[i]);
+        TEST_ASSERT_TRUE(decodeMessage(payload, &message));
+
+        TEST_ASSERT_EQUAL(expectedCommands[i], command);
+        TEST_ASSERT_EQUAL(expectedCommands[i], message.command);
+        TEST_ASSERT_EQUAL(expectedValues[i], value);
+        TEST_ASSERT_EQUAL(expectedValues[i], message.value);
+    }
+}
+
+void test_decode_array_and_string_values()
+{
+    DeviceMessage message;
+
+    strcpy(payload, "{\"command\":24,\"value\":[42,5,1000,60000]}");
+    TEST_ASSERT_TRUE(decodeMessage(payload, &message));
+    TEST_ASSERT_EQUAL(REPORTING_CONFIGURATION, message.command);
+    TEST_ASSERT_EQUAL(4, message.valueCount);
+    TEST_ASSERT_EQUAL(60000, message.values[3]);
+
+    // The string is terminated inside the payload instead of copied
+    strcpy(payload, "{\"value\":\"Hello\",\"command\":10}");
+    TEST_ASSERT_TRUE(decodeMessage(payload, &message));
+    TEST_ASSERT_EQUAL(NOT_REGISTERED, message.command);
+    TEST_ASSERT_EQUAL_STRING("Hello", message.stringValue);
+    TEST_ASSERT_TRUE(message.stringValue > payload && message.stringValue < payload + sizeof(payload));
+}
+
+void test_decode_rejects_invalid_messages()
+{
+    const char *const invalid[] = {"", "[]", "{\"value\":1}", "{\"command\":", "{\"command\":1", "{\"command\" 1}", "{\"command\":x}"};
+    DeviceMessage message;
+
+    for (const char *text : invalid)
+    {
+        strcpy(payload, text);
+        TEST_ASSERT_FALSE_MESSAGE(decodeMessage(payload, &message), text);
+    }
+}
+
+void test_benchmark_decode_against_document()
+{
+    const size_t messageCount = sizeof(hubMessages) / sizeof(hubMessages[0]);
+    uint32_t documentCycles = 0, decodeCycles = 0;
+    int command, value;
+    DeviceMessage message;
+
+    CountingAllocator::allocations = 0;
+    CountingAllocator::bytes = 0;
+
+    for (int round = 0; round < DECODE_ROUNDS; round++)
+    {
+        for (size_t i = 0; i < messageCount; i++)
+        {
+            // Copying the payload is the same for both and not measured
+            strcpy(payload, hubMessages[i]);
+            uint32_t start = benchmarkCycles();
+            decodeWithDocument(payload, &command, &value);
+            documentCycles += benchmarkCycles() - start;
+
+            strcpy(payload, hubMessages[i]);
+            start = benchmarkCycles();
+            decodeMessage(payload, &message);
+            decodeCycles += benchmarkCycles() - start;
+        }
+    }
+
+    uint32_t decoded = DECODE_ROUNDS * messageCount;
+    BENCHMARK_MESSAGE("deserializeJson: %u cycles, %u allocations of %u byte per message", (unsigned)(documentCycles / decoded),
+                      (unsigned)(CountingAllocator::allocations / decoded), (unsigned)(CountingAllocator::bytes / decoded));
+    BENCHMARK_MESSAGE("decodeMessage: %u cycles per message, %.2f of deserializeJson, it does not use the heap",
+                      (unsigned)(decodeCycles / decoded), (double)decodeCycles / documentCycles);
+
+    TEST_ASSERT_EQUAL(decoded, CountingAllocator::allocations);
+
+    // Cycle counts are noisy on a shared host, only fail when decodeMessage is clearly slower
+    TEST_ASSERT_LESS_THAN(documentCycles, decodeCycles / 2);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_decode_matches_document);
+    RUN_TEST(test_decode_array_and_string_values);
+    RUN_TEST(test_decode_rejects_invalid_messages);
+    RUN_TEST(test_benchmark_decode_against_document);
+    return UNITY_END();
+}
@@ -0,0 +1,140 @@
+// Defines
+
+#define MESSAGE_COUNT 100
+#define HEARTBEAT_EVERY 5
+
+// Includes
+
+#include "DefaultFunctions.hpp"
+
+#include <unity.h>
+#include <libwsdeflate/wsdeflate.h>
+
+#include "../Benchmark.hpp"
+#include "../HubConnection.hpp"
+
+// Types
+
+struct DeflateSetting
+{
+    const char *name;
+    uint8_t windowBits; // 0 sends without permessage-deflate
+    bool takeover;
+};
+
+// Global variables
+
+std::vector<SentFrame> plainFrames;
+
+// Function definitions
+
+void setUp() {}
+
+void tearDown() {}
+
+/*!
+    @brief Sends the same telemetry every time: sensor values of the bed and a heartbeat now and then
+    @return The cycles it took to send the messages
+*/
+uint32_t sendTelemetry()
+{
+    WiFiClient::transmitted().clear();
+    uint32_t start = benchmarkCycles();
+
+    for (int i = 0; i < MESSAGE_COUNT; i++)
+    {
+        if (i % HEARTBEAT_EVERY == 0)
+        {
+            sendHeartbeat();
+            continue;
+        }
+
+        sendIntMessage(BED_PRESSURE_SENSOR_VALUE, (i * 37) % 256);
+        flushEventQueue(true);
+    }
+
+    return benchmarkCycles() - start;
+}
+
+/*!
+    @brief Inflates the frames the client sent and compares them with the messages sent without deflate
+    @param[in] frames The frames sent with permessage-deflate
+    @param[in] takeover The frames were compressed with context takeover
+*/
+void assertInflatesToPlain(const std::vector<SentFrame> &frames, bool takeover)
+{
+    // The receiver keeps the end of the compressed messages as dictionary
+    std::string window;
+    uint8_t message[256];
+
+    TEST_ASSERT_EQUAL(plainFrames.size(), frames.size());
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        if (!frames[i].compressed)
+        {
+            TEST_ASSERT_EQUAL_STRING(plainFrames[i].payload.c_str(), frames[i].payload.c_str());
+            continue;
+        }
+
+        int32_t length = wsdeflate_inflate((const uint8_t *)frames[i].payload.data(), frames[i].payload.size(), message, sizeof(message),
+                                           (const uint8_t *)window.data(), window.size());
+
+        TEST_ASSERT_EQUAL(plainFrames[i].payload.size(), length);
+        TEST_ASSERT_EQUAL_MEMORY(plainFrames[i].payload.data(), message, length);
+
+        if (takeover)
+        {
+            window.append((const char *)message, length);
+            window.erase(0, window.size() > 32768 ? window.size() - 32768 : 0);
+        }
+    }
+}
+
+void test_benchmark_deflate()
+{
+    const DeflateSetting settings[] = {
+        {"no deflate", 0, false},
+        {"9 bits, no context takeover", 9, false},
+        {"9 bits, context takeover", 9, true},
+    };
+    size_t wireBytes[3];
+
+    for (int s = 0; s < 3; s++)
+    {
+        HubConnection::open(webSocket, settings[s].windowBits, settings[s].takeover);
+
+        uint32_t cycles = sendTelemetry();
+        std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+        if (settings[s].windowBits == 0)
+        {
+            plainFrames = frames;
+        }
+        else
+        {
+            assertInflatesToPlain(frames, settings[s].takeover);
+        }
+
+        wireBytes[s] = WiFiClient::transmitted().size();
+        BENCHMARK_MESSAGE("%s: %u messages in %u byte, %u cycles per message", settings[s].name, MESSAGE_COUNT, (unsigned)wireBytes[s],
+                          (unsigned)(cycles / MESSAGE_COUNT));
+    }
+
+    TEST_ASSERT_LESS_THAN(wireBytes[0], wireBytes[1]);
+    TEST_ASSERT_LESS_THAN(wireBytes[1], wireBytes[2]);
+}
+
+int main()
+{
+    strcpy(UUID, "0123456789");
+    deviceType = "Bed";
+    websocketConnected = true;
+    renderMessageTemplate();
+
+    webSocket.setWriteMode(WSwrite_lowLatency);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_benchmark_deflate);
+    return UNITY_END();
+}
@@ -0,0 +1,256 @@
+// Defines
+
+#define FRAGMENT_SIZE 16
+#define REASSEMBLY_SIZE 64
+
+// Includes
+
+#include <Arduino.h>
+#include <unity.h>
+#include <WebSocketsClient.h>
+#include <libwsdeflate/wsdeflate.h>
+
+#include "../HubConnection.hpp"
+
+// Types
+
+// A message the client passed to its event callback
+struct ReceivedEvent
+{
+    WStype_t type;
+    std::string payload;
+};
+
+// Global variables
+
+WebSocketsClient client;
+std::vector<ReceivedEvent> events;
+
+// Function definitions
+
+void setUp()
+{
+    client.setFragmentSize(0);
+    client.setReassemblySize(REASSEMBLY_SIZE);
+    HubConnection::open(client);
+    events.clear();
+}
+
+void tearDown() {}
+
+/*!
+    @brief Keeps the events of the client
+    @param[in] type The type of the event
+    @param[in] payload The message of the event
+    @param[in] length The length of the message
+*/
+void clientEvent(WStype_t type, uint8_t *payload, size_t length)
+{
+    events.push_back({type, std::string((const char *)payload, payload ? length : 0)});
+}
+
+/*!
+    @brief Creates an unmasked frame like the hub sends it
+    @param[in] opcode The opcode of the frame
+    @param[in] fin Last frame of the message
+    @param[in] payload The payload of the frame
+    @param[in] compressed [OPTIONAL] Set RSV1, the message is deflated
+    @return The bytes of the frame
+*/
+std::string hubFrame(uint8_t opcode, bool fin, const std::string &payload, bool compressed = false)
+{
+    std::string frame;
+
+    frame += (char)((fin ? 0x80 : 0x00) | (compressed ? 0x40 : 0x00) | opcode);
+    if (payload.size() < 126)
+    {
+        frame += (char)payload.size();
+    }
+    else
+    {
+        frame += (char)126;
+        frame += (char)(payload.size() >> 8);
+        frame += (char)(payload.size() & 0xFF);
+    }
+    return frame + payload;
+}
+
+/*!
+    @brief Lets the client read the frames as if the hub sent them
+    @param[in] frames The bytes of the frames
+*/
+void receive(const std::string &frames)
+{
+    WiFiClient::received() = frames;
+
+    // One frame is handled per loop, the client is not looped after it closed the connection
+    while (!WiFiClient::received().empty() && client.isConnected())
+    {
+        client.loop();
+    }
+}
+
+/*!
+    @brief Checks that the client closed the connection with a close code
+    @param[in] code The expected close code
+*/
+void assertClosedWith(uint16_t code)
+{
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+    TEST_ASSERT_FALSE(client.isConnected());
+    TEST_ASSERT_EQUAL(WStype_DISCONNECTED, events.back().type);
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(WSop_close, frames[0].opcode);
+    TEST_ASSERT_EQUAL(2, frames[0].payload.size());
+    TEST_ASSERT_EQUAL(code, (uint8_t)frames[0].payload[0] << 8 | (uint8_t)frames[0].payload[1]);
+}
+
+void test_send_fragments()
+{
+    std::string message;
+    for (int i = 0; i < 3 * FRAGMENT_SIZE + 5; i++)
+    {
+        message += (char)('a' + i % 26);
+    }
+
+    client.setFragmentSize(FRAGMENT_SIZE);
+    client.sendTXT(message.c_str(), message.size());
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+    std::string joined;
+
+    TEST_ASSERT_EQUAL(4, frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        TEST_ASSERT_EQUAL(i == 0 ? WSop_text : WSop_continuation, frames[i].opcode);
+        TEST_ASSERT_EQUAL(i == frames.size() - 1, frames[i].fin);
+        TEST_ASSERT_FALSE(frames[i].compressed);
+        TEST_ASSERT_TRUE(frames[i].payload.size() <= FRAGMENT_SIZE);
+        joined += frames[i].payload;
+    }
+    TEST_ASSERT_EQUAL_STRING(message.c_str(), joined.c_str());
+}
+
+void test_send_small_message_unfragmented()
+{
+    const char message[] = "{\"command\":20}";
+
+    client.setFragmentSize(FRAGMENT_SIZE);
+    client.sendTXT(message);
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(WSop_text, frames[0].opcode);
+    TEST_ASSERT_TRUE(frames[0].fin);
+    TEST_ASSERT_EQUAL_STRING(message, frames[0].payload.c_str());
+}
+
+void test_send_compressed_message_unfragmented()
+{
+    // Compresses well but is still larger than a fragment after deflate
+    std::string message;
+    for (int i = 0; i < 200; i++)
+    {
+        message += (char)('a' + (i * 7) % 26);
+    }
+
+    HubConnection::open(client, 15);
+    client.setFragmentSize(FRAGMENT_SIZE);
+    client.sendTXT(message.c_str(), message.size());
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+    uint8_t inflated[256];
+
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL(WSop_text, frames[0].opcode);
+    TEST_ASSERT_TRUE(frames[0].fin);
+    TEST_ASSERT_TRUE(frames[0].compressed);
+    TEST_ASSERT_TRUE(frames[0].payload.size() > FRAGMENT_SIZE);
+
+    int32_t length = wsdeflate_inflate((const uint8_t *)frames[0].payload.data(), frames[0].payload.size(), inflated, sizeof(inflated), NULL, 0);
+    TEST_ASSERT_EQUAL(message.size(), length);
+    TEST_ASSERT_EQUAL_MEMORY(message.data(), inflated, length);
+}
+
+void test_receive_fragments_as_one_message()
+{
+    std::string message(REASSEMBLY_SIZE, 'x');
+    message[0] = '{';
+    message[REASSEMBLY_SIZE - 1] = '}';
+
+    receive(hubFrame(WSop_text, false, message.substr(0, 20)) + hubFrame(WSop_continuation, false, message.substr(20, 20)) +
+            hubFrame(WSop_continuation, true, message.substr(40)));
+
+    TEST_ASSERT_TRUE(client.isConnected());
+    TEST_ASSERT_EQUAL(1, events.size());
+    TEST_ASSERT_EQUAL(WStype_TEXT, events[0].type);
+    TEST_ASSERT_EQUAL_STRING(message.c_str(), events[0].payload.c_str());
+    TEST_ASSERT_EQUAL(0, HubConnection::sentFrames().size());
+}
+
+void test_receive_compressed_fragments()
+{
+    std::string message;
+    for (int i = 0; i < REASSEMBLY_SIZE; i++)
+    {
+        message += (char)('a' + (i * 3) % 26);
+    }
+
+    uint8_t deflated[128];
+    int32_t length = wsdeflate_compress((const uint8_t *)message.data(), message.size(), deflated, sizeof(deflated), 15, NULL, 0);
+    TEST_ASSERT_TRUE(length > 2);
+    std::string compressed((const char *)deflated, length);
+
+    HubConnection::open(client, 15);
+    receive(hubFrame(WSop_text, false, compressed.substr(0, length / 2), true) + hubFrame(WSop_continuation, true, compressed.substr(length / 2)));
+
+    TEST_ASSERT_TRUE(client.isConnected());
+    TEST_ASSERT_EQUAL(1, events.size());
+    TEST_ASSERT_EQUAL(WStype_TEXT, events[0].type);
+    TEST_ASSERT_EQUAL_STRING(message.c_str(), events[0].payload.c_str());
+}
+
+void test_receive_message_above_reassembly_size()
+{
+    receive(hubFrame(WSop_text, false, std::string(40, 'x')) + hubFrame(WSop_continuation, true, std::string(REASSEMBLY_SIZE - 39, 'x')));
+
+    TEST_ASSERT_EQUAL(1, events.size());
+    assertClosedWith(1009);
+}
+
+void test_receive_continuation_without_start()
+{
+    receive(hubFrame(WSop_continuation, true, "x"));
+
+    TEST_ASSERT_EQUAL(1, events.size());
+    assertClosedWith(1002);
+}
+
+void test_receive_new_message_before_end()
+{
+    receive(hubFrame(WSop_text, false, "{\"comm") + hubFrame(WSop_text, true, "{\"command\":20}"));
+
+    TEST_ASSERT_EQUAL(1, events.size());
+    assertClosedWith(1002);
+}
+
+int main()
+{
+    // The port lets loop() read, the connection itself is opened by HubConnection
+    client.begin("10.0.1.1", 9002);
+    client.onEvent(clientEvent);
+    client.setWriteMode(WSwrite_lowLatency);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_send_fragments);
+    RUN_TEST(test_send_small_message_unfragmented);
+    RUN_TEST(test_send_compressed_message_unfragmented);
+    RUN_TEST(test_receive_fragments_as_one_message);
+    RUN_TEST(test_receive_compressed_fragments);
+    RUN_TEST(test_receive_message_above_reassembly_size);
+    RUN_TEST(test_receive_continuation_without_start);
+    RUN_TEST(test_receive_new_message_before_end);
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+// Defines
+
+#define MESSAGE_COUNT 1000
+
+// Includes
+
+#include "DefaultFunctions.hpp"
+
+#include <unity.h>
+
+#include "../Benchmark.hpp"
+#include "../HubConnection.hpp"
+
+// Function definitions
+
+void setUp()
+{
+    WiFiClient::transmitted().clear();
+    eventQueueCount = 0;
+    messageProtocol = PROTOCOL_JSON;
+}
+
+void tearDown() {}
+
+/*!
+    @brief The sendIntMessage from before the message template, builds a JSON document for every message
+    @param[in] command The command send in the JSON packet, see CommandTypes.hpp
+    @param[in] value An integer value that is send with the command as parameter.
+*/
+void sendArduinoJsonMessage(int command, int value)
+{
+    StaticJsonDocument<200> message;
+    char stringMessage[200];
+
+    message["UUID"] = UUID;
+    message["Type"] = deviceType;
+    message["command"] = command;
+    message["value"] = value;
+
+    serializeJson(message, stringMessage);
+
+    Serial.printf("Sending message: %s\n", stringMessage);
+    webSocket.sendTXT(stringMessage);
+}
+
+/*!
+    @brief Sends a message through the template, as a single queued event
+*/
+void sendTemplateIntMessage(int command, int value)
+{
+    sendIntMessage(command, value);
+    flushEventQueue(true);
+}
+
+void test_template_matches_arduinojson()
+{
+    const int values[] = {0, 7, 255, 1023, -1, -32768, 2147483647};
+
+    for (int value : values)
+    {
+        WiFiClient::transmitted().clear();
+        sendArduinoJsonMessage(BED_PRESSURE_SENSOR_VALUE, value);
+        sendTemplateIntMessage(BED_PRESSURE_SENSOR_VALUE, value);
+
+        std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+        TEST_ASSERT_EQUAL(2, frames.size());
+        TEST_ASSERT_EQUAL_STRING(frames[0].payload.c_str(), frames[1].payload.c_str());
+    }
+}
+
+void test_heartbeat_has_no_value()
+{
+    sendHeartbeat();
+
+    std::vector<SentFrame> frames = HubConnection::sentFrames();
+
+    TEST_ASSERT_EQUAL(1, frames.size());
+    TEST_ASSERT_EQUAL_STRING("{\"UUID\":\"0123456789\",\"Type\":\"Bed\",\"command\":20}", frames[0].payload.c_str());
+}
+
+void test_benchmark_template_against_arduinojson()
+{
+    uint32_t start = benchmarkCycles();
+    for (int i = 0; i < MESSAGE_COUNT; i++)
+    {
+        sendArduinoJsonMessage(BED_PRESSURE_SENSOR_VALUE, i);
+    }
+    uint32_t documentCycles = benchmarkCycles() - start;
+
+    start = benchmarkCycles();
+    for (int i = 0; i < MESSAGE_COUNT; i++)
+    {
+        sendTemplateIntMessage(BED_PRESSURE_SENSOR_VALUE, i);
+    }
+    uint32_t templateCycles = benchmarkCycles() - start;
+
+    // Both include framing and masking in the WebSockets library, which is the same for both
+    BENCHMARK_MESSAGE("ArduinoJson document: %u cycles per message", (unsigned)(documentCycles / MESSAGE_COUNT));
+    BENCHMARK_MESSAGE("message template: %u cycles per message, %.2f of the document", (unsigned)(templateCycles / MESSAGE_COUNT),
+                      (double)templateCycles / documentCycles);
+
+    // Cycle counts are noisy on a shared host, only fail when the template is clearly slower
+    TEST_ASSERT_LESS_THAN(documentCycles, templateCycles / 2);
+}
+
+int main()
+{
+    strcpy(UUID, "0123456789");
+    deviceType = "Bed";
+    websocketConnected = true;
+    renderMessageTemplate();
+
+    webSocket.setWriteMode(WSwrite_lowLatency);
+    HubConnection::open(webSocket);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_template_matches_arduinojson);
+    RUN_TEST(test_heartbeat_has_no_value);
+    RUN_TEST(test_benchmark_template_against_arduinojson);
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+// Includes
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "SensorFilter.hpp"
+
+// Global variables
+
+Filter<Hysteresis<8>, Scale<1023, 255>> channelFilter;
+
+// Function definitions
+
+void setUp() {}
+
+void tearDown() {}
+
+/*!
+    @brief Feeds a value through a filter stage
+    @return The value the stage made of it, or 0xFFFF if the stage stopped the chain
+*/
+template <typename Stage>
+uint16_t feed(Stage &stage, uint16_t value)
+{
+    return stage.apply(value) ? value : 0xFFFF;
+}
+
+void test_median_warm_up()
+{
+    Median<5> median;
+
+    // Before the window is full the median is taken of the values received so far
+    TEST_ASSERT_EQUAL_UINT16(10, feed(median, 10));
+    TEST_ASSERT_EQUAL_UINT16(30, feed(median, 30));
+    TEST_ASSERT_EQUAL_UINT16(20, feed(median, 20));
+    TEST_ASSERT_EQUAL_UINT16(30, feed(median, 1000));
+    TEST_ASSERT_EQUAL_UINT16(25, feed(median, 25));
+}
+
+void test_median_removes_spikes()
+{
+    Median<3> median;
+
+    feed(median, 100);
+    feed(median, 100);
+    TEST_ASSERT_EQUAL_UINT16(100, feed(median, 1023));
+    TEST_ASSERT_EQUAL_UINT16(100, feed(median, 100));
+    TEST_ASSERT_EQUAL_UINT16(100, feed(median, 0));
+
+    // The oldest value leaves the window
+    TEST_ASSERT_EQUAL_UINT16(0, feed(median, 0));
+}
+
+void test_ema_priming()
+{
+    Ema<2> ema;
+
+    // The first value is passed unchanged instead of rising from zero
+    TEST_ASSERT_EQUAL_UINT16(100, feed(ema, 100));
+    TEST_ASSERT_EQUAL_UINT16(125, feed(ema, 200));
+    TEST_ASSERT_EQUAL_UINT16(144, feed(ema, 200));
+}
+
+void test_ema_rounding()
+{
+    Ema<2> ema;
+
+    feed(ema, 1);
+    // state 5 / 4 = 1.25 rounds down, state 6 / 4 = 1.5 rounds up
+    TEST_ASSERT_EQUAL_UINT16(1, feed(ema, 2));
+    TEST_ASSERT_EQUAL_UINT16(2, feed(ema, 2));
+
+    // A constant input converges to the input itself
+    for (int i = 0; i < 50; i++)
+    {
+        feed(ema, 1023);
+    }
+    TEST_ASSERT_EQUAL_UINT16(1023, feed(ema, 1023));
+}
+
+void test_hysteresis_boundary()
+{
+    Hysteresis<8> hysteresis;
+
+    TEST_ASSERT_EQUAL_UINT16(100, feed(hysteresis, 100));
+
+    // A difference of exactly B is not passed, B + 1 is
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, feed(hysteresis, 108));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, feed(hysteresis, 92));
+    TEST_ASSERT_EQUAL_UINT16(109, feed(hysteresis, 109));
+
+    // The reference is the last value that was passed, not the last value received
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, feed(hysteresis, 101));
+    TEST_ASSERT_EQUAL_UINT16(100, feed(hysteresis, 100));
+}
+
+void test_scale()
+{
+    Scale<1023, 255> scale;
+
+    TEST_ASSERT_EQUAL_UINT16(0, feed(scale, 0));
+    TEST_ASSERT_EQUAL_UINT16(127, feed(scale, 512));
+    TEST_ASSERT_EQUAL_UINT16(255, feed(scale, 1023));
+
+    // Values above the input range are clamped instead of overflowing the output range
+    TEST_ASSERT_EQUAL_UINT16(255, feed(scale, 1024));
+    TEST_ASSERT_EQUAL_UINT16(255, feed(scale, 0xFFFF));
+}
+
+void test_chain_stops_at_hysteresis()
+{
+    bool (*apply)(uint16_t &value) = SENSOR_FILTER(channelFilter);
+    uint16_t value = 1023;
+
+    TEST_ASSERT_TRUE(apply(value));
+    TEST_ASSERT_EQUAL_UINT16(255, value);
+
+    // The stages after a stage that stops the chain do not touch the value
+    value = 1020;
+    TEST_ASSERT_FALSE(apply(value));
+    TEST_ASSERT_EQUAL_UINT16(1020, value);
+}
+
+int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_median_warm_up);
+    RUN_TEST(test_median_removes_spikes);
+    RUN_TEST(test_ema_priming);
+    RUN_TEST(test_ema_rounding);
+    RUN_TEST(test_hysteresis_boundary);
+    RUN_TEST(test_scale);
+    RUN_TEST(test_chain_stops_at_hysteresis);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    // Give the serial monitor time to connect
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main()
+{
+    return runTests();
+}
+#endif
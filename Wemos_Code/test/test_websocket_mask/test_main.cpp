@@ -0,0 +1,153 @@
+// Defines
+
+#define MASK_ALIGNMENTS 8
+#define MASK_RUNS 5
+
+// Includes
+
+#include <Arduino.h>
+#include <unity.h>
+#include <WebSockets.h>
+
+#include "../Benchmark.hpp"
+
+// Types
+
+// Exposes the protected masking kernel of the WebSockets library
+struct MaskAccess : WebSockets
+{
+    using WebSockets::maskPayload;
+};
+
+// Global variables
+
+const uint8_t maskKey[4] = {0x37, 0xFA, 0x21, 0x3D};
+
+uint8_t payload[WEBSOCKETS_MAX_DATA_SIZE + MASK_ALIGNMENTS];
+uint8_t expected[WEBSOCKETS_MAX_DATA_SIZE + MASK_ALIGNMENTS];
+
+// Function definitions
+
+void setUp() {}
+
+void tearDown() {}
+
+/*!
+    @brief The per byte loop that maskPayload replaced
+    @param[in,out] data The bytes to mask
+    @param[in] length The number of bytes
+    @param[in] offset The position of data[0] in the frame payload
+*/
+void maskBytewise(uint8_t *data, size_t length, size_t offset)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        data[i] ^= maskKey[(offset + i) % 4];
+    }
+}
+
+void fillPayload(size_t length)
+{
+    uint32_t seed = length * 2654435761u;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        payload[i] = seed >> 24;
+    }
+}
+
+void test_mask_equals_bytewise()
+{
+    // Every alignment of the buffer and every phase of the key around the word loop and its head and tail
+    for (size_t length = 0; length <= 200; length++)
+    {
+        for (size_t alignment = 0; alignment < MASK_ALIGNMENTS; alignment++)
+        {
+            for (size_t offset = 0; offset < 4; offset++)
+            {
+                fillPayload(length + MASK_ALIGNMENTS);
+                memcpy(expected, payload, length + MASK_ALIGNMENTS);
+
+                MaskAccess::maskPayload(payload + alignment, length, maskKey, offset);
+                maskBytewise(expected + alignment, length, offset);
+
+                // The bytes around the range must not be touched either
+                TEST_ASSERT_EQUAL_MEMORY(expected, payload, length + MASK_ALIGNMENTS);
+            }
+        }
+    }
+}
+
+void test_mask_is_its_own_inverse()
+{
+    fillPayload(WEBSOCKETS_MAX_DATA_SIZE);
+    memcpy(expected, payload, WEBSOCKETS_MAX_DATA_SIZE);
+
+    MaskAccess::maskPayload(payload + 1, WEBSOCKETS_MAX_DATA_SIZE - 1, maskKey, 0);
+    TEST_ASSERT_TRUE(memcmp(expected, payload, WEBSOCKETS_MAX_DATA_SIZE) != 0);
+
+    // Unmasking in two parts, as a payload that arrives in chunks
+    MaskAccess::maskPayload(payload + 1, 1001, maskKey, 0);
+    MaskAccess::maskPayload(payload + 1002, WEBSOCKETS_MAX_DATA_SIZE - 1002, maskKey, 1001);
+    TEST_ASSERT_EQUAL_MEMORY(expected, payload, WEBSOCKETS_MAX_DATA_SIZE);
+}
+
+/*!
+    @brief Runs one masking function a few times over the payload buffer
+    @return The lowest cycle count of the runs
+*/
+template <typename Mask>
+uint32_t measure(size_t length, Mask mask)
+{
+    uint32_t best = UINT32_MAX;
+
+    for (int run = 0; run < MASK_RUNS; run++)
+    {
+        uint32_t start = benchmarkCycles();
+        mask(payload, length);
+        best = min(best, benchmarkCycles() - start);
+    }
+    return best;
+}
+
+void test_benchmark_mask_sweep()
+{
+    const size_t lengths[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, WEBSOCKETS_MAX_DATA_SIZE};
+
+    fillPayload(WEBSOCKETS_MAX_DATA_SIZE);
+
+    for (size_t length : lengths)
+    {
+        uint32_t bytewise = measure(length, [](uint8_t *data, size_t length) { maskBytewise(data, length, 0); });
+        uint32_t kernel = measure(length, [](uint8_t *data, size_t length) { MaskAccess::maskPayload(data, length, maskKey, 0); });
+
+        BENCHMARK_MESSAGE("%5u byte: bytewise %6u cycles, maskPayload %6u cycles (%u.%02ux)", (unsigned)length, (unsigned)bytewise,
+                          (unsigned)kernel, (unsigned)(bytewise / max(kernel, 1u)), (unsigned)(bytewise * 100 / max(kernel, 1u) % 100));
+    }
+}
+
+int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mask_equals_bytewise);
+    RUN_TEST(test_mask_is_its_own_inverse);
+    RUN_TEST(test_benchmark_mask_sweep);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    // Give the serial monitor time to connect
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main()
+{
+    return runTests();
+}
+#endif